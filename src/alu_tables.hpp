@@ -0,0 +1,161 @@
+/******************************************************************************
+ * File: alu_tables.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file alu_tables.hpp
+//!
+//! Precomputed results and flags for the 8-bit ALU, generated at compile time.
+//!
+//! Only used when built with GSGB_ALU_TABLES; otherwise the ALU computes flags
+//! arithmetically and lazily. Which is faster depends on the host's cache: the
+//! add/sub tables alone are 512KB.
+//!
+//! Flag bits use the layout of Cpu::registers.r8.F and each table sets exactly
+//! the flags the matching Cpu::Impl operation does.
+#ifndef ALU_TABLES_VERSION
+#define ALU_TABLES_VERSION "0.1.0" //!< include guard
+
+#include <array>
+#include <cstdint>
+
+namespace gs {
+
+        //! Result and flags of one 8-bit ALU operation.
+        struct AluResult {
+                uint8_t result;
+                uint8_t flags;
+        };
+
+        namespace alu {
+
+                constexpr uint8_t S = 0x80;
+                constexpr uint8_t Z = 0x40;
+                constexpr uint8_t H = 0x10;
+                constexpr uint8_t P = 0x04;
+                constexpr uint8_t N = 0x02;
+                constexpr uint8_t C = 0x01;
+
+                //! Shift and rotate kinds, in 0xCB opcode order.
+                enum Shift { RLC, RRC, RL, RR, SLA, SRA, SWAP, SRL };
+
+                //! \return P if parity is even
+                constexpr uint8_t Parity(uint8_t byte) {
+                        byte ^= byte >> 4;
+                        byte ^= byte >> 2;
+                        byte ^= byte >> 1;
+                        return (byte & 1) ? 0 : P;
+                }
+
+                //! Index with carry << 16 | left << 8 | right.
+                constexpr std::array<AluResult, 0x20000> MakeArithmetic(bool subtract) {
+                        std::array<AluResult, 0x20000> t = {};
+                        for (uint32_t i = 0; i < t.size(); i++) {
+                                uint32_t carry = i >> 16;
+                                uint32_t left = (i >> 8) & 0xFF;
+                                uint32_t right = i & 0xFF;
+                                uint32_t result = subtract ? left - right - carry : left + right + carry;
+                                uint32_t carries = left ^ right ^ result;
+
+                                uint8_t flags = subtract ? N : 0;
+                                flags |= (result & 0xFF) ? 0 : Z;
+                                flags |= (carries & 0x10) ? H : 0;
+                                flags |= (result & 0x100) ? C : 0;
+                                t[i] = { static_cast<uint8_t>(result), flags };
+                        }
+                        return t;
+                }
+
+                //! INC or DEC; C is left alone.
+                constexpr std::array<AluResult, 0x100> MakeStep(bool decrement) {
+                        std::array<AluResult, 0x100> t = {};
+                        for (uint32_t i = 0; i < t.size(); i++) {
+                                uint8_t result = decrement ? i - 1 : i + 1;
+                                uint8_t flags = decrement ? N : 0;
+                                flags |= result ? 0 : Z;
+                                flags |= ((i ^ result) & 0x10) ? H : 0;
+                                t[i] = { result, flags };
+                        }
+                        return t;
+                }
+
+                //! Index with carry << 8 | value.
+                constexpr std::array<AluResult, 0x200> MakeShift(Shift kind) {
+                        std::array<AluResult, 0x200> t = {};
+                        for (uint32_t i = 0; i < t.size(); i++) {
+                                uint8_t value = i & 0xFF;
+                                uint8_t carryIn = i >> 8;
+                                uint8_t result = 0;
+                                uint8_t carry = 0;
+                                switch (kind) {
+                                        case RLC: carry = value >> 7; result = (value << 1) | carry; break;
+                                        case RRC: carry = value & 1; result = (value >> 1) | (carry << 7); break;
+                                        case RL: carry = value >> 7; result = (value << 1) | carryIn; break;
+                                        case RR: carry = value & 1; result = (value >> 1) | (carryIn << 7); break;
+                                        case SLA: carry = value >> 7; result = value << 1; break;
+                                        case SRA: carry = value & 1; result = (value >> 1) | (value & 0x80); break;
+                                        case SWAP: result = (value << 4) | (value >> 4); break;
+                                        case SRL: carry = value & 1; result = value >> 1; break;
+                                }
+
+                                uint8_t flags = (result ? 0 : Z) | (carry ? C : 0);
+                                if (kind <= SLA) {
+                                        // These also keep the Z80's sign and parity.
+                                        flags |= (result & 0x80) ? S : 0;
+                                        flags |= Parity(result);
+                                }
+                                t[i] = { result, flags };
+                        }
+                        return t;
+                }
+
+                //! Index with N << 10 | C << 9 | H << 8 | A.
+                constexpr std::array<AluResult, 0x800> MakeDaa() {
+                        std::array<AluResult, 0x800> t = {};
+                        for (uint32_t i = 0; i < t.size(); i++) {
+                                uint8_t lo = i & 0xF;
+                                uint8_t hi = (i >> 4) & 0xF;
+                                bool halfCarry = i & 0x100;
+                                bool carry = i & 0x200;
+                                bool subtract = i & 0x400;
+
+                                if (lo > 9 || halfCarry) {
+                                        lo += subtract ? -6 : 6;
+                                }
+                                if (hi > 9 || carry) {
+                                        hi += subtract ? -6 : 6;
+                                }
+
+                                // Matches Cpu::Impl::DAA(), which does not mask lo.
+                                uint8_t result = (hi << 4) | lo;
+                                uint8_t flags = (result ? 0 : Z) | Parity(result) | (result > 0x99 ? C : 0);
+                                t[i] = { result, flags };
+                        }
+                        return t;
+                }
+
+                constexpr std::array<std::array<AluResult, 0x200>, 8> MakeShifts() {
+                        std::array<std::array<AluResult, 0x200>, 8> t = {};
+                        for (int kind = RLC; kind <= SRL; kind++) {
+                                t[kind] = MakeShift(static_cast<Shift>(kind));
+                        }
+                        return t;
+                }
+
+                inline constexpr std::array<AluResult, 0x20000> add = MakeArithmetic(false);
+                inline constexpr std::array<AluResult, 0x20000> sub = MakeArithmetic(true);
+                inline constexpr std::array<AluResult, 0x100> inc = MakeStep(false);
+                inline constexpr std::array<AluResult, 0x100> dec = MakeStep(true);
+                inline constexpr std::array<std::array<AluResult, 0x200>, 8> shift = MakeShifts();
+                inline constexpr std::array<AluResult, 0x800> daa = MakeDaa();
+
+        } // namespace alu
+
+} // namespace gs
+
+#endif // ALU_TABLES_VERSION
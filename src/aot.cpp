@@ -0,0 +1,114 @@
+/******************************************************************************
+ * File: aot.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file aot.cpp
+#include <cstring>
+
+#include "aot.hpp"
+#include "block_cache.hpp"
+#include "bus.hpp"
+
+#if defined(__unix__) && !defined(GSGB_NO_AOT)
+#define GS_AOT_DLOPEN 1
+#include <dlfcn.h>
+#else
+#define GS_AOT_DLOPEN 0
+#endif
+
+namespace gs {
+
+        static uint8_t Read(void *bus, uint16_t addr) {
+                return static_cast<Bus *>(bus)->read(addr);
+        }
+
+        static void Write(void *bus, uint16_t addr, uint8_t value) {
+                static_cast<Bus *>(bus)->write(addr, value);
+        }
+
+        Aot::Aot(const AotHooks &hooks) : hooks(hooks) {
+                this->hooks.read = &Read;
+                this->hooks.write = &Write;
+        }
+
+        Aot::~Aot() {
+#if GS_AOT_DLOPEN
+                if (library != nullptr) {
+                        dlclose(library);
+                }
+#endif
+        }
+
+        bool Aot::load(const char *path, uint16_t globalChecksum, uint64_t romHash) {
+#if GS_AOT_DLOPEN
+                if (library != nullptr || bus == nullptr) {
+                        return false;
+                }
+
+                void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+                if (handle == nullptr) {
+                        return false;
+                }
+
+                typedef const AotModule *(*Entry)();
+                Entry entry = reinterpret_cast<Entry>(dlsym(handle, AotEntry));
+                const AotModule *candidate = (entry != nullptr) ? entry() : nullptr;
+                if (candidate == nullptr ||
+                    0 != memcmp(candidate->magic, AotMagic, sizeof(AotMagic)) ||
+                    candidate->version != AotVersion ||
+                    candidate->globalChecksum != globalChecksum ||
+                    candidate->romHash != romHash) {
+                        dlclose(handle);
+                        return false;
+                }
+
+                hooks.bus = bus;
+                candidate->bind(hooks);
+                library = handle;
+                module = candidate;
+                return true;
+#else
+                (void)path;
+                (void)globalChecksum;
+                (void)romHash;
+                return false;
+#endif
+        }
+
+        Aot::Native Aot::find(uint16_t bank, const Block &block) const {
+                if (module == nullptr) {
+                        return nullptr;
+                }
+
+                // Binary search on (bank, start).
+                uint32_t key = static_cast<uint32_t>(bank) << 16 | block.start;
+                uint32_t lo = 0;
+                uint32_t hi = module->count;
+                while (lo < hi) {
+                        uint32_t mid = lo + (hi - lo) / 2;
+                        const AotBlock &b = module->blocks[mid];
+                        uint32_t midKey = static_cast<uint32_t>(b.bank) << 16 | b.start;
+                        if (midKey < key) {
+                                lo = mid + 1;
+                        } else {
+                                hi = mid;
+                        }
+                }
+
+                if (lo == module->count) {
+                        return nullptr;
+                }
+                const AotBlock &b = module->blocks[lo];
+                if (b.bank != bank || b.start != block.start || b.end != block.end || b.cycles != block.cycles) {
+                        return nullptr; // Built differently; the interpreter decides.
+                }
+                return b.native;
+        }
+
+} // namespace gs
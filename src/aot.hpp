@@ -0,0 +1,70 @@
+/******************************************************************************
+ * File: aot.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file aot.hpp
+//!
+//! Ahead-of-time compiled ROM blocks.
+//!
+//! gsgb-aot (src/tools/aot.cpp) walks the code reachable in a ROM and writes
+//! it out as C++, one function per basic block. Compiled into a shared
+//! library, load() makes those functions available to Cpu::runCycles(), which
+//! runs them in place of interpreting the matching blocks. Blocks the module
+//! doesn't have, and anything outside ROM, are interpreted as usual; the JIT
+//! can still pick those up.
+//!
+//! Loading needs dlopen(), so is only available on Unix hosts and not when
+//! built with GSGB_NO_AOT.
+#ifndef AOT_VERSION
+#define AOT_VERSION "0.1.0" //!< include guard
+
+#include <cstdint>
+
+#include "aot_abi.hpp"
+
+namespace gs {
+
+        class Bus;
+        struct Block;
+
+        class Aot {
+        public:
+                typedef void (*Native)();
+
+                //! \param hooks guest state and interpreter entry points; the
+                //!        Bus accessors are filled in here
+                Aot(const AotHooks &hooks);
+                ~Aot();
+
+                //! \brief Load a module built for the ROM with globalChecksum
+                //!        and contentHash romHash.
+                //!
+                //! Modules embed immediates and jump targets from the ROM,
+                //! so one built from another revision of it is refused even
+                //! when the global checksum matches.
+                //!
+                //! Only one module can be loaded, after the Cpu is attached to
+                //! a Bus.
+                //! \return whether the module was loaded
+                bool load(const char *path, uint16_t globalChecksum, uint64_t romHash);
+
+                //! \return compiled code for block in bank, or nullptr
+                Native find(uint16_t bank, const Block &block) const;
+
+                Bus *bus = nullptr; //!< set by Cpu::attach()
+
+        private:
+                AotHooks hooks;
+                const AotModule *module = nullptr;
+                void *library = nullptr;
+        };
+
+} // namespace gs
+
+#endif // AOT_VERSION
@@ -0,0 +1,139 @@
+/******************************************************************************
+ * File: aot_abi.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file aot_abi.hpp
+//!
+//! Interface between the emulator and modules written by gsgb-aot.
+//!
+//! Generated modules include this header and nothing else from gsgb, so it
+//! must stay self-contained. Bump AotVersion whenever anything here changes
+//! shape or meaning; the emulator refuses modules built for another version.
+#ifndef AOT_ABI_VERSION
+#define AOT_ABI_VERSION "0.1.0" //!< include guard
+
+#include <cstdint>
+
+namespace gs {
+
+        static const uint32_t AotVersion = 2;
+        static const char AotMagic[8] = { 'G', 'S', 'G', 'B', 'A', 'O', 'T', '1' };
+
+        //! Guest state and interpreter entry points, handed to a module once
+        //! when it is loaded.
+        struct AotHooks {
+                uint8_t *registers; //!< Cpu::registers: C, B, E, D, L, H, F, A
+                uint16_t *pc; //!< Cpu::PC
+                uint32_t *imm; //!< immediate operand read by opcode handlers
+                void *impl; //!< first argument to interpret
+                void (*interpret)(void *impl, unsigned int index); //!< run one opcode handler
+                void *bus; //!< first argument to read and write
+                uint8_t (*read)(void *bus, uint16_t addr);
+                void (*write)(void *bus, uint16_t addr, uint8_t value);
+        };
+
+        //! One compiled basic block. Blocks match those the interpreter builds
+        //! for the same bank and start exactly, or they aren't used.
+        struct AotBlock {
+                uint16_t bank; //!< ROM bank for 0x4000-0x7FFF, otherwise 0
+                uint16_t start;
+                uint16_t end;
+                uint32_t cycles; //!< sum of base cycle costs
+                void (*native)();
+        };
+
+        struct AotModule {
+                char magic[8]; //!< AotMagic
+                uint32_t version; //!< AotVersion
+                uint16_t globalChecksum; //!< of the ROM the module was built from
+                uint64_t romHash; //!< Cartridge::contentHash() of that ROM
+                uint32_t count;
+                const AotBlock *blocks; //!< sorted by bank, then start
+                void (*bind)(const AotHooks &hooks);
+        };
+
+        //! Name of the function every module exports, with C linkage, as
+        //! `const gs::AotModule *gsgb_aot_module()`.
+        static const char *const AotEntry = "gsgb_aot_module";
+
+        //! Helpers for generated code. Registers are indexed as in
+        //! AotHooks::registers; flags follow the interpreter's F layout.
+        namespace aot {
+                enum Register { C = 0, B, E, D, L, H, F, A };
+
+                static const uint8_t FlagZ = 0x40;
+                static const uint8_t FlagH = 0x10;
+                static const uint8_t FlagN = 0x02;
+                static const uint8_t FlagC = 0x01;
+                static const uint8_t FlagsZHNC = FlagZ | FlagH | FlagN | FlagC;
+
+                inline void Flags(uint8_t *r, uint8_t mask, uint8_t bits) {
+                        r[F] = static_cast<uint8_t>((r[F] & ~mask) | bits);
+                }
+
+                inline uint16_t Pair(const uint8_t *r, Register lo) {
+                        return static_cast<uint16_t>(r[lo + 1] << 8 | r[lo]);
+                }
+
+                inline void SetPair(uint8_t *r, Register lo, uint16_t value) {
+                        r[lo] = static_cast<uint8_t>(value);
+                        r[lo + 1] = static_cast<uint8_t>(value >> 8);
+                }
+
+                //! \brief Z, H and C from a full-width 8-bit result, as the
+                //! interpreter's lazy flags compute them.
+                inline uint8_t Arith(unsigned int left, unsigned int right, unsigned int result) {
+                        return static_cast<uint8_t>(((result & 0xFF) ? 0 : FlagZ) |
+                                                    (((left ^ right ^ result) & 0x10) ? FlagH : 0) |
+                                                    ((result & 0x100) ? FlagC : 0));
+                }
+
+                //! \brief ALU operation on A in opcode order: ADD ADC SUB SBC AND XOR OR CP.
+                inline void Alu(uint8_t *r, unsigned int op, uint8_t value) {
+                        unsigned int a = r[A];
+                        unsigned int carry = r[F] & FlagC;
+                        unsigned int result;
+                        switch (op) {
+                                case 0: case 1:
+                                        result = a + value + (op == 1 ? carry : 0);
+                                        r[A] = static_cast<uint8_t>(result);
+                                        Flags(r, FlagsZHNC, Arith(a, value, result));
+                                        return;
+                                case 2: case 3: case 7:
+                                        result = a - value - (op == 3 ? carry : 0);
+                                        if (op != 7) {
+                                                r[A] = static_cast<uint8_t>(result);
+                                        }
+                                        Flags(r, FlagsZHNC, Arith(a, value, result) | FlagN);
+                                        return;
+                                default:
+                                        r[A] = static_cast<uint8_t>(op == 4 ? a & value : op == 5 ? a ^ value : a | value);
+                                        Flags(r, FlagsZHNC, r[A] ? 0 : FlagZ);
+                                        return;
+                        }
+                }
+
+                //! INC and DEC leave C alone.
+                inline uint8_t IncDec(uint8_t *r, uint8_t value, bool dec) {
+                        unsigned int result = dec ? value - 1u : value + 1u;
+                        Flags(r, FlagZ | FlagH | FlagN, (Arith(value, 1, result) & ~FlagC) | (dec ? FlagN : 0));
+                        return static_cast<uint8_t>(result);
+                }
+
+                //! \param pc address following the instruction
+                inline void Interpret(const AotHooks &h, uint16_t pc, unsigned int index, uint32_t imm) {
+                        *h.pc = pc;
+                        *h.imm = imm;
+                        h.interpret(h.impl, index);
+                }
+        } // namespace aot
+
+} // namespace gs
+
+#endif // AOT_ABI_VERSION
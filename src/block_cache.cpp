@@ -0,0 +1,134 @@
+/******************************************************************************
+ * File: block_cache.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file block_cache.cpp
+#include <cassert>
+#include <cstring>
+
+#include "block_cache.hpp"
+
+namespace gs {
+
+        BlockCache::BlockCache() {
+                direct = new Block*[0x10000]();
+                memset(codePages, 0, sizeof(codePages));
+                dirty = false;
+        }
+
+        BlockCache::~BlockCache() {
+                delete[] direct;
+        }
+
+        Block *BlockCache::find(uint16_t pc, uint16_t bank) {
+                uint32_t k = key(pc, bank);
+
+                Block *block = direct[pc];
+                if (block != nullptr && block->key == k) {
+                        return block;
+                }
+
+                auto it = blocks.find(k);
+                if (it == blocks.end()) {
+                        return nullptr;
+                }
+
+                direct[pc] = it->second.get();
+                return direct[pc];
+        }
+
+        Block *BlockCache::insert(std::unique_ptr<Block> block) {
+                assert(!block->ops.empty());
+
+                Block *result = block.get();
+                if (result->start >= 0x8000) {
+                        ramBlocks.push_back(result);
+                        markPages(*result);
+                }
+
+                direct[result->start] = result;
+                blocks[result->key] = std::move(block);
+                return result;
+        }
+
+        void BlockCache::flush() {
+                for (auto &entry : blocks) {
+                        retired.push_back(std::move(entry.second));
+                }
+                blocks.clear();
+                ramBlocks.clear();
+                for (uint32_t i = 0; i < 0x10000; i++) {
+                        direct[i] = nullptr;
+                }
+                memset(codePages, 0, sizeof(codePages));
+                dirty = true;
+        }
+
+        unsigned int BlockCache::echoAlias(unsigned int page) {
+                const unsigned int distance = (EchoStart - WramStart) >> PageShift;
+                if (page >= (WramStart >> PageShift) && page < (EchoEnd >> PageShift) - distance) {
+                        return page + distance;
+                }
+                if (page >= (EchoStart >> PageShift) && page < (EchoEnd >> PageShift)) {
+                        return page - distance;
+                }
+                return page;
+        }
+
+        //! \brief Set the bits for every page block's bytes lie on, and for
+        //! their aliases, so a write through either address is seen.
+        void BlockCache::markPages(const Block &block) {
+                uint32_t end = block.end > block.start ? block.end : 0x10000;
+                for (uint32_t page = block.start >> PageShift; page <= (end - 1) >> PageShift; page++) {
+                        unsigned int alias = echoAlias(page);
+                        codePages[page >> 6] |= static_cast<uint64_t>(1) << (page & 63);
+                        codePages[alias >> 6] |= static_cast<uint64_t>(1) << (alias & 63);
+                }
+        }
+
+        void BlockCache::invalidatePage(unsigned int page) {
+                stats.codeWrites++;
+
+                // Blocks may have been decoded at either of the page's addresses.
+                uint32_t low = page << PageShift;
+                uint32_t high = low + (1u << PageShift);
+                uint32_t aliasLow = echoAlias(page) << PageShift;
+                uint32_t aliasHigh = aliasLow + (1u << PageShift);
+                for (std::size_t i = 0; i < ramBlocks.size();) {
+                        Block *block = ramBlocks[i];
+                        uint32_t end = block->end > block->start ? block->end : 0x10000;
+                        bool overlaps = block->start < high && end > low;
+                        bool overlapsAlias = block->start < aliasHigh && end > aliasLow;
+                        if (!overlaps && !overlapsAlias) {
+                                i++;
+                                continue;
+                        }
+
+                        if (direct[block->start] == block) {
+                                direct[block->start] = nullptr;
+                        }
+                        auto it = blocks.find(block->key);
+                        retired.push_back(std::move(it->second));
+                        blocks.erase(it);
+                        ramBlocks[i] = ramBlocks.back();
+                        ramBlocks.pop_back();
+                        stats.blocksInvalidated++;
+                }
+
+                // A dropped block may have shared pages with one that's left.
+                for (unsigned int p = 0x8000 >> PageShift; p < Pages; p++) {
+                        codePages[p >> 6] &= ~(static_cast<uint64_t>(1) << (p & 63));
+                }
+                for (Block *block : ramBlocks) {
+                        markPages(*block);
+                }
+                dirty = true;
+        }
+
+} // namespace gs
@@ -0,0 +1,143 @@
+/******************************************************************************
+ * File: block_cache.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file block_cache.hpp
+//!
+//! Cache of pre-decoded basic blocks for Cpu::runCycles().
+//!
+//! A block is a straight run of instructions starting at some PC and ending
+//! with the first instruction that can transfer control. Blocks are keyed on
+//! PC plus the ROM bank mapped at 0x4000-0x7FFF, so bank switching never
+//! needs to invalidate anything. ROM cannot change under us; code in RAM
+//! (0x8000 and up) can, eg. an OAM DMA routine copied to HRAM. A bitmap marks
+//! the 256-byte pages holding cached RAM code, so a bus write to RAM costs one
+//! bit test, and a write to a marked page drops just the blocks on that page.
+//! Counters in stats show how often that happens.
+//!
+//! Invalidation can happen in the middle of the block being executed, so
+//! invalidated blocks are retired rather than freed, and reclaim() frees
+//! them once the caller is at a block boundary.
+#ifndef BLOCK_CACHE_VERSION
+#define BLOCK_CACHE_VERSION "0.1.0" //!< include guard
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace gs {
+
+        //! A single pre-decoded instruction.
+        struct DecodedOp {
+                uint16_t index; //!< dispatch table index; 0x100-0x1FF for 0xCB opcodes, 0x200 up for superinstructions
+                uint32_t imm; //!< immediate operand, if any; superinstructions pack their parts' bytes in order
+                uint8_t length; //!< encoded length in bytes
+                uint8_t cycles; //!< base cycle cost
+        };
+
+        struct Block {
+                uint32_t key; //!< see BlockCache::key()
+                uint16_t start; //!< address of the first instruction
+                uint16_t end; //!< address following the last instruction
+                uint32_t cycles; //!< sum of base cycle costs
+                std::vector<DecodedOp> ops;
+                uint32_t hits = 0; //!< executions counted towards Jit::Threshold
+                void (*native)() = nullptr; //!< compiled by Jit or loaded by Aot, if any
+                bool jitted = false; //!< native came from Jit, so only runs while it is enabled
+                uint16_t poll = 0; //!< register read by an idle polling loop; see Cpu::Impl::findPoll()
+        };
+
+        class BlockCache {
+        public:
+                static const unsigned int MaxOps = 64; //!< longest block built
+                static const unsigned int PageShift = 8; //!< RAM code is tracked in 256-byte pages
+                static const unsigned int Pages = 0x10000 >> PageShift;
+
+                //! Invalidation counters, for tuning and diagnostics.
+                struct Stats {
+                        uint64_t codeWrites = 0; //!< writes to a page holding cached code
+                        uint64_t blocksInvalidated = 0; //!< blocks dropped by those writes
+                };
+
+                BlockCache();
+                ~BlockCache();
+
+                //! \return cache key for a block starting at pc
+                //! \param bank ROM bank mapped at 0x4000-0x7FFF; only significant
+                //!        when pc lies in that range.
+                static uint32_t key(uint16_t pc, uint16_t bank) {
+                        bool banked = (pc & 0xC000) == 0x4000;
+                        return (static_cast<uint32_t>(banked ? bank : 0) << 16) | pc;
+                }
+
+                Block *find(uint16_t pc, uint16_t bank);
+                Block *insert(std::unique_ptr<Block> block);
+                void flush();
+
+                //! Call visit(const Block &) for every cached block.
+                template<typename Visit> void forEach(Visit visit) const {
+                        for (const auto &entry : blocks) {
+                                visit(*entry.second);
+                        }
+                }
+
+                //! Notify the cache of a bus write. Cheap unless addr lies on
+                //! a page of cached RAM code. Echo RAM is folded onto the WRAM
+                //! it mirrors, so either address drops blocks at the other.
+                void written(uint16_t addr) {
+                        if (addr >= EchoStart && addr < EchoEnd) {
+                                addr -= EchoStart - WramStart;
+                        }
+                        unsigned int page = addr >> PageShift;
+                        if ((codePages[page >> 6] >> (page & 63)) & 1) {
+                                invalidatePage(page);
+                        }
+                }
+
+                //! \return the bitmap written() tests, one bit per page; both
+                //!         a WRAM page and its echo are set when either holds code
+                const uint64_t *codePageBits() const {
+                        return codePages;
+                }
+
+                //! Free blocks retired by invalidation. Only call this when no
+                //! block is being executed.
+                void reclaim() {
+                        retired.clear();
+                        dirty = false;
+                }
+
+                //! Set when blocks were invalidated since the last reclaim();
+                //! the block being executed may be stale.
+                bool dirty;
+
+                Stats stats;
+
+        private:
+                static const uint32_t WramStart = 0xC000;
+                static const uint32_t EchoStart = 0xE000; //!< mirrors WRAM up to EchoEnd
+                static const uint32_t EchoEnd = 0xFE00;
+
+                //! \return page's alias in WRAM or echo RAM, or page if it has none
+                static unsigned int echoAlias(unsigned int page);
+
+                void invalidatePage(unsigned int page);
+                void markPages(const Block &block);
+
+                std::unordered_map<uint32_t, std::unique_ptr<Block>> blocks;
+                std::vector<std::unique_ptr<Block>> retired;
+                std::vector<Block *> ramBlocks; //!< cached blocks starting at 0x8000 or above
+                Block **direct; //!< direct-mapped by PC, checked against key
+                uint64_t codePages[Pages / 64]; //!< bit per page holding part of a RAM block
+        };
+
+} // namespace gs
+
+#endif // BLOCK_CACHE_VERSION
@@ -0,0 +1,245 @@
+/******************************************************************************
+ * File: block_store.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file block_store.cpp
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "block_cache.hpp"
+#include "block_store.hpp"
+
+#if defined(__unix__)
+#define GS_STORE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define GS_STORE_MMAP 0
+#endif
+
+namespace gs {
+
+        //! \brief Append ops to out through zeroed records, so the store
+        //! never holds whatever was in DecodedOp's padding.
+        static void appendOps(std::vector<DecodedOp> &out, const DecodedOp *first, const DecodedOp *last) {
+                for (; first != last; first++) {
+                        DecodedOp op;
+                        memset(&op, 0, sizeof(op));
+                        op.index = first->index;
+                        op.imm = first->imm;
+                        op.length = first->length;
+                        op.cycles = first->cycles;
+                        out.push_back(op);
+                }
+        }
+
+        const char BlockStore::Magic[8] = { 'G', 'S', 'G', 'B', 'B', 'L', 'K', '1' };
+
+        BlockStore::BlockStore(uint16_t globalChecksum, uint64_t romHash, uint32_t decoder)
+                : globalChecksum(globalChecksum), romHash(romHash), decoder(decoder) {}
+
+        BlockStore::~BlockStore() {
+                close();
+        }
+
+        void BlockStore::close() {
+#if GS_STORE_MMAP
+                if (mapping != nullptr) {
+                        munmap(mapping, mappedSize);
+                }
+#endif
+                mapping = nullptr;
+                mappedSize = 0;
+                buffer.clear();
+                blocks = nullptr;
+                count = 0;
+                ops = nullptr;
+                opCount = 0;
+        }
+
+        bool BlockStore::open(const char *path) {
+                close();
+
+                const uint8_t *data = nullptr;
+                std::size_t size = 0;
+#if GS_STORE_MMAP
+                int fd = ::open(path, O_RDONLY);
+                if (fd < 0) {
+                        return false;
+                }
+                struct stat info;
+                if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                        void *p = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (p != MAP_FAILED) {
+                                mapping = p;
+                                mappedSize = static_cast<std::size_t>(info.st_size);
+                        }
+                }
+                ::close(fd); // The mapping outlives the descriptor.
+                data = static_cast<const uint8_t *>(mapping);
+                size = mappedSize;
+#else
+                FILE *file = std::fopen(path, "rb");
+                if (file == nullptr) {
+                        return false;
+                }
+                uint8_t chunk[4096];
+                std::size_t n;
+                while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+                        buffer.insert(buffer.end(), chunk, chunk + n);
+                }
+                std::fclose(file);
+                data = buffer.data();
+                size = buffer.size();
+#endif
+
+                BlockStoreHeader header;
+                if (data == nullptr || size < sizeof(header)) {
+                        close();
+                        return false;
+                }
+                memcpy(&header, data, sizeof(header));
+
+                std::size_t tableEnd = sizeof(header) + static_cast<std::size_t>(header.count) * sizeof(StoredBlock);
+                if (0 != memcmp(header.magic, Magic, sizeof(Magic)) ||
+                    header.version != Version ||
+                    header.decoder != decoder ||
+                    header.romHash != romHash ||
+                    header.globalChecksum != globalChecksum ||
+                    header.opSize != sizeof(DecodedOp) ||
+                    tableEnd > size) {
+                        close();
+                        return false;
+                }
+
+                blocks = reinterpret_cast<const StoredBlock *>(data + sizeof(header));
+                count = header.count;
+                ops = reinterpret_cast<const DecodedOp *>(data + tableEnd);
+                opCount = (size - tableEnd) / sizeof(DecodedOp);
+                return true;
+        }
+
+        const StoredBlock *BlockStore::find(uint32_t key) const {
+                uint32_t lo = 0;
+                uint32_t hi = count;
+                while (lo < hi) {
+                        uint32_t mid = lo + (hi - lo) / 2;
+                        if (blocks[mid].key < key) {
+                                lo = mid + 1;
+                        } else {
+                                hi = mid;
+                        }
+                }
+                return (lo < count && blocks[lo].key == key) ? &blocks[lo] : nullptr;
+        }
+
+        bool BlockStore::load(uint32_t key, unsigned int indices, Block &block) const {
+                const StoredBlock *stored = find(key);
+                if (stored == nullptr || stored->opCount == 0 ||
+                    static_cast<std::size_t>(stored->firstOp) + stored->opCount > opCount ||
+                    stored->start != (key & 0xFFFF) || stored->end <= stored->start) {
+                        return false;
+                }
+                uint32_t length = 0;
+                for (const DecodedOp *op = ops + stored->firstOp; op != ops + stored->firstOp + stored->opCount; op++) {
+                        if (op->index >= indices || op->length == 0) {
+                                return false;
+                        }
+                        length += op->length;
+                }
+                if (length != static_cast<uint32_t>(stored->end - stored->start)) {
+                        return false; // Decoded fresh instead.
+                }
+
+                block.key = stored->key;
+                block.start = stored->start;
+                block.end = stored->end;
+                block.cycles = stored->cycles;
+                block.ops.assign(ops + stored->firstOp, ops + stored->firstOp + stored->opCount);
+                block.poll = stored->poll;
+                block.hits = stored->hits;
+                return true;
+        }
+
+        bool BlockStore::save(const char *path, const BlockCache &cache) const {
+                // Blocks decoded this run replace stored ones, keeping the
+                // higher entry count.
+                std::map<uint32_t, StoredBlock> table;
+                std::vector<DecodedOp> out;
+                cache.forEach([&](const Block &block) {
+                        if (block.start >= 0x8000) {
+                                return; // RAM code may be different next time.
+                        }
+                        StoredBlock &s = table[block.key];
+                        const StoredBlock *old = find(block.key);
+                        s.key = block.key;
+                        s.start = block.start;
+                        s.end = block.end;
+                        s.cycles = block.cycles;
+                        s.firstOp = static_cast<uint32_t>(out.size());
+                        s.opCount = static_cast<uint16_t>(block.ops.size());
+                        s.poll = block.poll;
+                        s.hits = (old != nullptr && old->hits > block.hits) ? old->hits : block.hits;
+                        appendOps(out, block.ops.data(), block.ops.data() + block.ops.size());
+                });
+                for (uint32_t i = 0; i < count; i++) {
+                        const StoredBlock &old = blocks[i];
+                        if (table.count(old.key) != 0 || static_cast<std::size_t>(old.firstOp) + old.opCount > opCount) {
+                                continue;
+                        }
+                        StoredBlock &s = table[old.key];
+                        s = old;
+                        s.firstOp = static_cast<uint32_t>(out.size());
+                        appendOps(out, ops + old.firstOp, ops + old.firstOp + old.opCount);
+                }
+
+                BlockStoreHeader header;
+                memset(&header, 0, sizeof(header));
+                memcpy(header.magic, Magic, sizeof(Magic));
+                header.version = Version;
+                header.decoder = decoder;
+                header.romHash = romHash;
+                header.globalChecksum = globalChecksum;
+                header.opSize = sizeof(DecodedOp);
+                header.count = static_cast<uint32_t>(table.size());
+
+                std::string temporary = path;
+#if GS_STORE_MMAP
+                temporary += "." + std::to_string(getpid());
+#endif
+                temporary += ".tmp";
+
+                FILE *file = std::fopen(temporary.c_str(), "wb");
+                if (file == nullptr) {
+                        return false;
+                }
+                bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+                for (const auto &entry : table) {
+                        ok = ok && std::fwrite(&entry.second, sizeof(StoredBlock), 1, file) == 1;
+                }
+                ok = ok && (out.empty() || std::fwrite(out.data(), sizeof(DecodedOp), out.size(), file) == out.size());
+                ok = (0 == std::fclose(file)) && ok;
+
+#if !GS_STORE_MMAP
+                if (ok) {
+                        std::remove(path); // rename() won't replace a file here.
+                }
+#endif
+                if (!ok || 0 != std::rename(temporary.c_str(), path)) {
+                        std::remove(temporary.c_str());
+                        return false;
+                }
+                return true;
+        }
+
+} // namespace gs
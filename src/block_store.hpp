@@ -0,0 +1,112 @@
+/******************************************************************************
+ * File: block_store.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file block_store.hpp
+//!
+//! Decoded ROM blocks kept between runs.
+//!
+//! A store file holds the ROM blocks earlier runs decoded, superinstructions
+//! already fused, along with how often each was entered. open() maps the file
+//! into memory; Cpu::runCycles() then copies blocks out of it rather than
+//! decoding them, and blocks that were hot enough for the JIT last time are
+//! compiled the first time they run instead of after Jit::Threshold entries.
+//!
+//! A file is only used for the ROM it was saved from, as identified by global
+//! checksum and a hash of the ROM's contents, and only by a decoder with the
+//! same Cpu::decoderSignature(). JIT output is not stored: it embeds host
+//! addresses that are only valid in the process that produced it.
+#ifndef BLOCK_STORE_VERSION
+#define BLOCK_STORE_VERSION "0.1.0" //!< include guard
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gs {
+
+        struct Block;
+        struct DecodedOp;
+        class BlockCache;
+
+        //! Start of a store file; followed by count StoredBlocks sorted by
+        //! key, then the DecodedOps they refer to.
+        struct BlockStoreHeader {
+                char magic[8]; //!< BlockStore::Magic
+                uint32_t version; //!< BlockStore::Version
+                uint32_t decoder; //!< Cpu::decoderSignature()
+                uint64_t romHash; //!< Cartridge::contentHash()
+                uint16_t globalChecksum; //!< Cartridge::globalChecksum()
+                uint16_t opSize; //!< sizeof(DecodedOp)
+                uint32_t count; //!< number of blocks
+        };
+
+        struct StoredBlock {
+                uint32_t key; //!< see BlockCache::key()
+                uint16_t start;
+                uint16_t end;
+                uint32_t cycles;
+                uint32_t firstOp; //!< index of the block's first DecodedOp
+                uint16_t opCount;
+                uint16_t poll;
+                uint32_t hits;
+        };
+
+        class BlockStore {
+        public:
+                static const char Magic[8];
+                static const uint32_t Version = 1;
+
+                BlockStore(uint16_t globalChecksum, uint64_t romHash, uint32_t decoder);
+                ~BlockStore();
+
+                //! \brief Map the store at path.
+                //! \return false if it is missing, unreadable or was saved for
+                //!         another ROM or decoder; nothing is loaded then
+                bool open(const char *path);
+
+                //! \brief Fill in block from the stored block with key.
+                //!
+                //! The stored block is checked against the key and its own
+                //! ops, so a damaged file can't hand the interpreter an op it
+                //! has no handler for.
+                //! \param indices number of dispatch table entries; ops with
+                //!        an index past them are rejected
+                //! \return whether the store has that block, intact
+                bool load(uint32_t key, unsigned int indices, Block &block) const;
+
+                //! \brief Write the ROM blocks in cache, and those stored and not
+                //!        since decoded, to path.
+                //!
+                //! The file is written alongside and renamed into place, so
+                //! processes sharing a store never see it half written.
+                //! \return whether the file was written
+                bool save(const char *path, const BlockCache &cache) const;
+
+        private:
+                const StoredBlock *find(uint32_t key) const;
+                void close();
+
+                uint16_t globalChecksum;
+                uint64_t romHash;
+                uint32_t decoder;
+
+                void *mapping = nullptr;
+                std::size_t mappedSize = 0;
+                std::vector<uint8_t> buffer; //!< file contents where it can't be mapped
+
+                const StoredBlock *blocks = nullptr;
+                uint32_t count = 0;
+                const DecodedOp *ops = nullptr;
+                std::size_t opCount = 0;
+        };
+
+} // namespace gs
+
+#endif // BLOCK_STORE_VERSION
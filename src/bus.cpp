@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: bus.cpp
  * Created: 2019-09-07
- * Updated: 2021-01-04
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -13,6 +13,7 @@
 #include <cassert>
 
 #include "bus.hpp"
+#include "block_cache.hpp"
 #include "cpu.hpp"
 #include "cartridge.hpp"
 #include "video.hpp"
@@ -35,6 +36,11 @@ namespace gs {
                 RegLCDC = 0xFF40,
         };
 
+        enum AddrInterruptEnum {
+                InterruptFlag = 0xFF0F,
+                InterruptEnable = 0xFFFF,
+        };
+
         enum AddrSerialEnum {
                 SerialTransfer = 0xFF01,
                 SerialControl = 0xFF02,
@@ -50,6 +56,7 @@ namespace gs {
                 MemBgMapData2 = 0x9C00,
                 MemCartRam = 0xA000,
                 MemInternalRamBank0 = 0xC000,
+                MemEchoRam = 0xE000, // Mirrors 0xC000-0xDDFF.
                 MemOam = 0xFE00,
                 MemRegisters = 0xFF00, // Hardware I/O registers.
                 MemZeroPage = 0xFF80,
@@ -66,83 +73,226 @@ namespace gs {
         //! all operations.
         char *bootRom = {}; //!< Boot rom and DRM check.
 
+        static const unsigned int WramSize = 8 * 1024;
+        static const unsigned int HramSize = MemInterruptEnable - MemZeroPage;
+
+        //! Bits of each I/O register that read as 1 on a DMG, whatever was
+        //! written. Unmapped and write-only registers read as 0xFF.
+        //! \see https://gbdev.io/pandocs/Hardware_Reg_List.html
+        static const uint8_t IoUnused[Bus::IoPorts] = {
+                // P1    SB    SC          DIV   TIMA  TMA   TAC
+                0xC0, 0x00, 0x7E, 0xFF, 0x00, 0x00, 0x00, 0xF8,
+                //                                             IF
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xE0,
+                // NR10  NR11  NR12  NR13  NR14        NR21  NR22
+                0x80, 0x3F, 0x00, 0xFF, 0xBF, 0xFF, 0x3F, 0x00,
+                // NR23  NR24  NR30  NR31  NR32  NR33  NR34
+                0xFF, 0xBF, 0x7F, 0xFF, 0x9F, 0xFF, 0xBF, 0xFF,
+                // NR41  NR42  NR43  NR44  NR50  NR51  NR52
+                0xFF, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x70, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                // Wave RAM
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                // LCDC  STAT  SCY   SCX   LY    LYC   DMA   BGP
+                0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                // OBP0  OBP1  WY    WX
+                0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+                // BOOT
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        };
+
         Bus::Bus() {
                 cart = nullptr;
                 cpu = nullptr;
                 video = nullptr;
 
-                // RAM starts at 0xC000
-                memory = new uint8_t[8 * 1024];
+                // WRAM, then HRAM.
+                memory = new uint8_t[WramSize + HramSize]();
+                map(0x0000, 0xFFFF);
+
+                // Every register starts as a latch holding 0, the boot
+                // flag included.
+                for (unsigned int i = 0; i < IoPorts; i++) {
+                        io[i] = 0x00;
+                }
+
+                memRegisters.intFlag = 0x0;
+                memRegisters.intEnable = 0x0;
+
+                IoPort port;
+                port.device = this;
 
-                // Set boot state.
-                write(RegBOOT, 0x0);
+                // Bring IF up to date first so reads see requests that are
+                // due and writes can clear them.
+                port.read = [](void *bus, uint16_t) -> uint8_t {
+                        Bus *self = static_cast<Bus *>(bus);
+                        self->advance(self->cpu->cycles);
+                        return self->memRegisters.intFlag;
+                };
+                port.write = [](void *bus, uint16_t, uint8_t value) {
+                        Bus *self = static_cast<Bus *>(bus);
+                        self->advance(self->cpu->cycles);
+                        self->memRegisters.intFlag = value & 0x1F;
+                        self->cpu->raiseAttention();
+                };
+                connect(InterruptFlag, port);
 
-                memRegisters.boot = 0x0;
+                // SB is a latch. Before a transfer, it holds the next byte
+                // that will go out. During a transfer, it has a blend of the
+                // outgoing and incoming bytes. Each cycle, the leftmost bit is
+                // shifted out (and over the wire) and the incoming bit is
+                // shifted in from the other side.
+                //
+                // SC:
+                // bit 7: transfer start flag
+                //        0: no transfer in progress or requested
+                //        1: transfer in progress or requested
+                // bit 1: shift clock
+                //        0: external clock
+                //        1: internal clock
+                port.read = nullptr;
+                port.write = [](void *bus, uint16_t, uint8_t value) {
+                        Bus *self = static_cast<Bus *>(bus);
+                        uint8_t &sc = self->io[SerialControl - MemRegisters];
+                        sc = value;
+                        // There is no link partner; an internally clocked
+                        // transfer completes immediately.
+                        if (0x81 == (value & 0x81)) {
+                                self->serialOut.push_back(static_cast<char>(self->io[SerialTransfer - MemRegisters]));
+                                sc &= 0x7F;
+                        }
+                };
+                connect(SerialControl, port);
         }
 
         Bus::~Bus() {
                 delete[] memory;
         }
 
-        void Bus::write(uint16_t ptr, uint8_t value) {
-                if (cart != nullptr && cart->write(ptr, value)) {
+        void Bus::connect(uint16_t addr, const IoPort &port) {
+                assert(addr >= MemRegisters && addr < MemZeroPage);
+                ports[addr - MemRegisters] = port;
+        }
+
+        void Bus::writeSlow(uint16_t ptr, uint8_t value) {
+                if (ptr >= MemRegisters && ptr < MemZeroPage) {
+                        unsigned int i = ptr - MemRegisters;
+                        const IoPort &port = ports[i];
+                        if (port.write == nullptr) {
+                                io[i] = value;
+                                return;
+                        }
+                        if (port.reschedules) {
+                                advance(cpu->cycles);
+                        }
+                        port.write(port.device, ptr, value);
+                        if (port.reschedules) {
+                                cpu->raiseAttention();
+                        }
                         return;
-                } else if (video != nullptr && video->write(ptr, value)) {
+                }
+
+                if (ptr >= 0x8000 && cpu != nullptr) {
+                        cpu->cache->written(ptr);
+                }
+
+                if (ptr >= MemZeroPage && ptr < MemInterruptEnable) {
+                        memory[WramSize + (ptr - MemZeroPage)] = value;
+                        return;
+                } else if (ptr == MemInterruptEnable) {
+                        memRegisters.intEnable = value;
+                        cpu->raiseAttention();
                         return;
                 }
 
-                switch (ptr) {
-                        case AddrMemRegEnum::RegBOOT:
-                                memRegisters.boot = value;
-                                break;
-
-                        // Before a transfer, it holds the next byte that will
-                        // go out.
-                        // During a transfer, it has a blend of the outgoing and
-                        // incoming bytes. Each cycle, the leftmost bit is
-                        // shifted out (and over the wire) and the incoming bit
-                        // is shifted in from the other side.
-                        case AddrSerialEnum::SerialTransfer:
-                                memRegisters.sb = value;
-                                break;
-
-                        // bit 7: transfer start flag
-                        //        0: no transfer in progress or requested
-                        //        1: transfer in progress or requested
-                        // bit 1: shift clock
-                        //        0: external clock
-                        //        1: internal clock
-                        case AddrSerialEnum::SerialControl:
-                                memRegisters.sc = value;
-                                break;
-
-                        default:
-                                break;
+                if (cart != nullptr && cart->write(ptr, value)) {
+                        if (cart->mapVersion() != cartMap) {
+                                map(0x0000, 0x7FFF);
+                                map(0xA000, 0xBFFF);
+                        }
+                } else if (video != nullptr) {
+                        video->write(ptr, value);
                 }
         }
 
-        uint8_t Bus::read(uint16_t ptr) {
+        uint8_t Bus::readSlow(uint16_t ptr) {
+                if (ptr >= MemRegisters && ptr < MemZeroPage) {
+                        unsigned int i = ptr - MemRegisters;
+                        const IoPort &port = ports[i];
+                        uint8_t value = (port.read != nullptr) ? port.read(port.device, ptr) : io[i];
+                        return value | IoUnused[i];
+                } else if (ptr >= MemZeroPage && ptr < MemInterruptEnable) {
+                        return memory[WramSize + (ptr - MemZeroPage)];
+                } else if (ptr == MemInterruptEnable) {
+                        return memRegisters.intEnable;
+                }
+
                 uint8_t value;
                 if (cart != nullptr && cart->read(ptr, value)) {
                         return value;
                 } else if (video != nullptr && video->read(ptr, value)) {
                         return value;
                 }
+                return 0;
+        }
 
-                switch (ptr) {
-                        case AddrMemRegEnum::RegBOOT:
-                                return memRegisters.boot;
+        void Bus::map(uint16_t first, uint16_t last) {
+                if (cart != nullptr) {
+                        cartMap = cart->mapVersion();
+                }
+                for (unsigned int page = first >> PageShift; page <= (last >> PageShift); page++) {
+                        uint16_t addr = static_cast<uint16_t>(page << PageShift);
+                        readPages[page] = nullptr;
+                        writePages[page] = nullptr;
+                        if (addr >= MemInternalRamBank0 && addr < MemOam) {
+                                readPages[page] = writePages[page] = &memory[(addr - MemInternalRamBank0) % WramSize];
+                        } else if (cart != nullptr && (addr <= 0x7FFF || (addr >= 0xA000 && addr <= 0xBFFF))) {
+                                readPages[page] = cart->readPage(addr);
+                                writePages[page] = cart->writePage(addr);
+                        } else if (video != nullptr) {
+                                readPages[page] = writePages[page] = video->page(addr);
+                        }
+                }
+        }
 
-                        case AddrSerialEnum::SerialTransfer:
-                                return memRegisters.sb;
+        uint16_t Bus::romBank() const {
+                return (cart != nullptr) ? cart->romBank() : 0;
+        }
 
-                        case AddrSerialEnum::SerialControl:
-                                return memRegisters.sc;
-                }
+        //! Only the video is clocked; serial transfers complete as soon as
+        //! they start and there is no timer yet.
+        uint64_t Bus::nextEvent(uint64_t now) const {
+                return (video != nullptr) ? video->nextEvent(now) : UINT64_MAX;
+        }
+
+        //! Only registers driven by the clock are known. Anything else may be
+        //! changed by the host between runs, so is reported as unknown.
+        uint64_t Bus::nextChange(uint16_t addr, uint64_t now) const {
+                switch (addr) {
+                        case AddrInterruptEnum::InterruptFlag:
+                                return nextEvent(now);
 
+                        case AddrMemRegEnum::RegSTAT:
+                        case AddrMemRegEnum::RegLY:
+                                return (video != nullptr) ? video->nextChange(addr, now) : UINT64_MAX;
+                }
                 return 0;
         }
 
+        void Bus::advance(uint64_t now) {
+                uint8_t raised = (video != nullptr) ? video->advance(now) : 0;
+                if (raised != 0) {
+                        memRegisters.intFlag |= raised;
+                        cpu->raiseAttention();
+                }
+        }
+
         void Bus::attach(Cartridge *cart) {
                 cpu->registers.r16.AF = 0x0001;
                 cpu->registers.r16.BC = 0x0013;
@@ -150,20 +300,32 @@ namespace gs {
                 cpu->registers.r16.HL = 0x014D;
                 cpu->SP = 0xFFFE;
                 this->cart = cart;
+                map(0x0000, 0xFFFF);
         }
 
         void Bus::attach(Cpu *cpu) {
                 this->cpu = cpu;
+                code = cpu->cache;
                 cpu->attach(this);
+                if (video != nullptr) {
+                        video->clock = &cpu->cycles;
+                }
         }
 
         void Bus::attach(Video *video) {
                 this->video = video;
+                video->clock = (cpu != nullptr) ? &cpu->cycles : nullptr;
+                video->connect(*this);
+                map(0x0000, 0xFFFF);
         }
 
         //! \see https://gbdev.io/pandocs/#power-up-sequence
         void Bus::reset() {
                 cpu->reset();
+                if (video != nullptr) {
+                        video->reset();
+                }
+                memRegisters.intFlag = 0x0;
                 cpu->registers.r16.AF = 0x01B0;
                 cpu->registers.r16.BC = 0x0013;
                 cpu->registers.r16.DE = 0x00D8;
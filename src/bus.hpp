@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: bus.hpp
  * Created: 2019-08-30
- * Updated: 2021-01-04
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -13,31 +13,129 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <vector>
+
+#include "block_cache.hpp"
 
 namespace gs {
         class Cpu;
         class Cartridge;
         class Video;
 
+        //! Handlers for one I/O register in 0xFF00-0xFF7F; see Bus::connect().
+        struct IoPort {
+                uint8_t (*read)(void *device, uint16_t addr) = nullptr;
+                void (*write)(void *device, uint16_t addr, uint8_t value) = nullptr;
+                void *device = nullptr; //!< first argument to read and write
+
+                //! Writes change when the device next raises an interrupt.
+                //! The Bus brings IF up to date before them and has the CPU
+                //! look at it again after.
+                bool reschedules = false;
+        };
+
+        //! read() and write() look up the 256-byte page an address lies on.
+        //! Pages backed by plain host memory, WRAM and its echo included, are
+        //! accessed in place; the rest take readSlow() and writeSlow().
+        //! Those serve HRAM and the I/O registers straight away, as they
+        //! share a page, and otherwise ask each device in turn.
+        //!
+        //! Each I/O register has an IoPort. One without handlers is a plain
+        //! latch in the Bus's register file. Reads of either set the bits
+        //! the hardware leaves unused.
         class Bus {
+        public:
+                static const unsigned int PageShift = 8;
+                static const unsigned int Pages = 0x10000 >> PageShift;
+                static const unsigned int IoPorts = 0x80; //!< 0xFF00-0xFF7F
+
         private:
-                uint8_t *memory;
+                uint8_t *memory; //!< WRAM (0xC000-0xDFFF), then HRAM (0xFF80-0xFFFE)
                 Cpu *cpu;
                 Cartridge *cart;
                 Video *video;
+                BlockCache *code = nullptr; //!< Cpu::cache, told of RAM writes
+                uint32_t cartMap = 0; //!< Cartridge::mapVersion() the page table reflects
+
+                const uint8_t *readPages[Pages]; //!< first byte of each page, or nullptr
+                uint8_t *writePages[Pages]; //!< as readPages, for writes
+
+                IoPort ports[IoPorts];
+                uint8_t io[IoPorts]; //!< register file for latches
+
+                uint8_t readSlow(uint16_t ptr);
+                void writeSlow(uint16_t ptr, uint8_t value);
+
+                //! Refresh the page table entries for first through last.
+                void map(uint16_t first, uint16_t last);
 
         public:
                 struct {
-                        uint8_t boot; // boot flag
-                        uint8_t sb; // serial byte
-                        uint8_t sc; // serial control
+                        uint8_t intFlag; // IF: interrupts requested
+                        uint8_t intEnable; // IE: interrupts enabled
                 } memRegisters;
 
+                //! Bytes shifted out over the serial port, in order. Drained by the host.
+                std::vector<char> serialOut;
+
                 Bus();
                 ~Bus();
 
-                void write(uint16_t ptr, uint8_t value);
-                uint8_t read(uint16_t ptr);
+                void write(uint16_t ptr, uint8_t value) {
+                        uint8_t *page = writePages[ptr >> PageShift];
+                        if (page == nullptr) {
+                                writeSlow(ptr, value);
+                                return;
+                        }
+                        // Only RAM is mapped for writing.
+                        if (code != nullptr) {
+                                code->written(ptr);
+                        }
+                        page[ptr & 0xFF] = value;
+                }
+
+                uint8_t read(uint16_t ptr) {
+                        const uint8_t *page = readPages[ptr >> PageShift];
+                        return (page != nullptr) ? page[ptr & 0xFF] : readSlow(ptr);
+                }
+
+                //! The page tables behind read() and write(), for code
+                //! generators that inline them. Entries change when the
+                //! cartridge remaps, so look them up at access time.
+                const uint8_t *const *readTable() const {
+                        return readPages;
+                }
+
+                uint8_t *const *writeTable() const {
+                        return writePages;
+                }
+
+                //! \return the block cache write() notifies, or nullptr
+                const BlockCache *codeCache() const {
+                        return code;
+                }
+
+                uint16_t romBank() const;
+
+                //! \return clock of the next peripheral event after now that
+                //!         may request an interrupt, or UINT64_MAX
+                uint64_t nextEvent(uint64_t now) const;
+
+                //! \return clock after now at which the register at addr may
+                //!         change by itself, UINT64_MAX if never, or 0 if
+                //!         unknown
+                uint64_t nextChange(uint16_t addr, uint64_t now) const;
+
+                //! Catch peripherals up to now, requesting any interrupts due.
+                void advance(uint64_t now);
+
+                //! \return requested interrupts that are also enabled
+                uint8_t pendingInterrupts() const {
+                        return memRegisters.intFlag & memRegisters.intEnable & 0x1F;
+                }
+
+                //! Route accesses to the I/O register at addr through port.
+                void connect(uint16_t addr, const IoPort &port);
 
                 void attach(Cartridge *cart);
                 void attach(Cpu *cpu);
@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: cartridge.cpp
  * Created: 2019-09-24
- * Updated: 2020-12-30
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -102,10 +102,11 @@ namespace gs {
         };
 #pragma pack(pop)
 
-        Cartridge::Cartridge(uint8_t *rom, unsigned int size) {
+        Cartridge::Cartridge(const uint8_t *rom, unsigned int size) : rom(rom), romSize(size) {
                 mbc = nullptr;
 
-                CartHeader header = *reinterpret_cast<CartHeader*>(&rom[0x100]);
+                CartHeader header = *reinterpret_cast<const CartHeader*>(&rom[0x100]);
+                checksum = static_cast<uint16_t>(rom[0x14E] << 8 | rom[0x14F]); // big-endian
 
                 std::cout << header;
 
@@ -182,7 +183,7 @@ namespace gs {
                 }
                 assert(mbc != nullptr);
 
-                mbc->loadRom(rom);
+                mbc->loadRom(rom, size);
         }
 
         Cartridge::~Cartridge() {
@@ -197,4 +198,31 @@ namespace gs {
                 return mbc->read(addr, value);
         }
 
+        uint16_t Cartridge::romBank() const {
+                return mbc->romBank();
+        }
+
+        const uint8_t *Cartridge::readPage(uint16_t addr) {
+                return mbc->readPage(addr);
+        }
+
+        uint8_t *Cartridge::writePage(uint16_t addr) {
+                return mbc->writePage(addr);
+        }
+
+        uint64_t Cartridge::contentHash() const {
+                if (!hashed) {
+                        hash = 14695981039346656037ULL;
+                        for (unsigned int i = 0; i < romSize; i++) {
+                                hash = (hash ^ rom[i]) * 1099511628211ULL;
+                        }
+                        hashed = true;
+                }
+                return hash;
+        }
+
+        uint32_t Cartridge::mapVersion() const {
+                return mbc->mapVersion();
+        }
+
 } // namespace gs
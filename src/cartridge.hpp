@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: cartridge.hpp
  * Created: 2019-09-24
- * Updated: 2020-12-30
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -25,12 +25,39 @@ namespace gs {
         class Cartridge {
         private:
                 Mbc *mbc;
+                uint16_t checksum; //!< global checksum from the header
+                const uint8_t *rom; //!< the image hashed by contentHash()
+                unsigned int romSize;
+                mutable uint64_t hash = 0; //!< of the whole ROM, once hashed
+                mutable bool hashed = false;
         public:
-                Cartridge(uint8_t *rom, unsigned int size);
+                //! \param rom read in place by the MBC; must outlive the Cartridge
+                Cartridge(const uint8_t *rom, unsigned int size);
                 ~Cartridge();
 
                 bool write(uint16_t ptr, uint8_t value);
                 bool read(uint16_t ptr, uint8_t &value);
+                uint16_t romBank() const;
+
+                //! \see Mbc::readPage()
+                const uint8_t *readPage(uint16_t ptr);
+
+                //! \see Mbc::writePage()
+                uint8_t *writePage(uint16_t ptr);
+
+                //! \see Mbc::mapVersion()
+                uint32_t mapVersion() const;
+
+                //! \return header global checksum (0x014E-0x014F); identifies the ROM
+                uint16_t globalChecksum() const {
+                        return checksum;
+                }
+
+                //! \return 64-bit FNV-1a hash of the ROM's contents; unlike the
+                //!         global checksum, any change to the ROM changes it.
+                //!         Computed on the first call, as only the block store
+                //!         and AOT modules need it.
+                uint64_t contentHash() const;
         };
 } // namespace gs
 
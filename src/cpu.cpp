@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: Cpu.cpp
  * Created: 2019-08-29
- * Updated: 2021-01-02
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -10,44 +10,74 @@
  ******************************************************************************/
 //! \file cpu.cpp
 
-#include <string>
-#include <map>
+#include <array>
 #include <cassert>
-#include <iostream>
-#include <iomanip>
+#include <cstdio>
+#include <tuple>
+#include <type_traits>
 
 #include "cpu.hpp"
 #include "bus.hpp"
+#include "jit.hpp"
+#include "aot.hpp"
 #include "operand.hpp"
+#include "trace.hpp"
+#include "profile.hpp"
+#include "stack_profile.hpp"
+#include "block_store.hpp"
+#if defined(GSGB_ALU_TABLES)
+#include "alu_tables.hpp"
+#endif
 
 #include "cpu_impl.cpp"
 
 namespace gs {
 
-struct Instruction {
-        std::string name;
-        void (Cpu::Impl::*op)();
-        unsigned int cycles;
-
-        friend std::ostream& operator<<(std::ostream& out, Instruction i) {
-                using namespace std;
-                ostream fmt(NULL);
-                fmt.copyfmt(out);
-
-                out << "{ name: '" << i.name;
-                out << "', cycles: '" << dec << i.cycles << "' }";
-
-                out.copyfmt(fmt);
-                return out;
+template<typename F>
+auto Cpu::withCore(F f) {
+        if (accuracy == Accuracy::MCycle) {
+                return f(static_cast<Core<MCycleTiming> *>(impl));
         }
-};
+        return f(static_cast<Core<FastTiming> *>(impl));
+}
 
-Cpu::Cpu() {
-        impl = new Impl(this);
+Cpu::Cpu(Accuracy accuracy) : accuracy(accuracy) {
+        if (accuracy == Accuracy::MCycle) {
+                impl = new Core<MCycleTiming>(this);
+        } else {
+                impl = new Core<FastTiming>(this);
+        }
+        cache = new BlockCache();
+
+        Jit::Hooks hooks;
+        hooks.registers = reinterpret_cast<uint8_t *>(&registers);
+        hooks.pc = &PC;
+        hooks.imm = &impl->imm;
+        withCore([&hooks](auto *core) {
+                using CoreType = std::remove_pointer_t<decltype(core)>;
+                hooks.impl = core;
+                hooks.interpret = &CoreType::Interpret;
+        });
+        hooks.unfuse = &Impl::Unfuse;
+        jit = new Jit(hooks);
+
+        AotHooks aotHooks = {};
+        aotHooks.registers = hooks.registers;
+        aotHooks.pc = hooks.pc;
+        aotHooks.imm = hooks.imm;
+        aotHooks.impl = hooks.impl;
+        aotHooks.interpret = hooks.interpret;
+        aot = new Aot(aotHooks);
         reset();
 }
 
 void Cpu::reset() {
+        impl->lazyMask = 0;
+        impl->takenCycles = 0;
+        impl->ime = false;
+        impl->imeDelayed = false;
+        cycles = 0;
+        attentionAt = 0;
         registers.r16.BC = 0;
         registers.r16.DE = 0;
         registers.r16.HL = 0;
@@ -60,12 +90,17 @@ void Cpu::reset() {
 }
 
 Cpu::~Cpu() {
+        delete aot;
+        delete jit;
+        delete cache;
         delete impl;
 }
 
 void Cpu::attach(Bus *bus) {
         this->bus = bus;
         impl->bus = bus;
+        jit->bus = bus;
+        aot->bus = bus;
 }
 
 void Cpu::flagSet(char c, uint8_t onOrOff) {
@@ -102,6 +137,7 @@ void Cpu::flagSet(char c, uint8_t onOrOff) {
 }
 
 void Cpu::flagSet(uint8_t bit, uint8_t onOrOff) {
+        impl->materializeFlags();
         uint8_t bitFlag = 1 << bit;
 
         if (onOrOff) {
@@ -145,3827 +181,1162 @@ uint8_t Cpu::flagGet(char c) {
 }
 
 uint8_t Cpu::flagGet(uint8_t bitToCheck) {
-        uint8_t bit = registers.r8.F & (1 << bitToCheck);
+        uint8_t bit = impl->flags() & (1 << bitToCheck);
         return bit >> bitToCheck;
 }
 
 Cpu::Impl::Impl(Cpu *CpuIn) {
         cpu = CpuIn;
-        InitInstructionMap();
 }
 
 Cpu::Impl::~Impl() {
 }
 
-uint8_t TwosComplement(uint8_t num) {
-        return (~num) + 1;
-}
-
-//! \brief Get the low or high nibble from byte
-//! \param byte value to get nibble from
-//! \param pos 0 for low nibble, 1 for high nibble.
-//! \return high or low nibble of byte as specified by pos
-uint8_t Nibble(uint8_t byte, uint8_t pos) {
-        uint8_t result;
-
-        if (pos) {
-                result = (byte & 0xF0) >> 4;
-        } else {
-                result = byte & 0x0F;
-        }
-
-        return result;
-}
-
-//! \return 1 if parity is even, otherwise 0
-//! \see https://stackoverflow.com/a/21618038
-int Parity(uint8_t byte) {
-        byte ^= byte >> 4;
-        byte ^= byte >> 2;
-        byte ^= byte >> 1;
-        return (~byte) & 1;
-}
-
 //-----------------------------------------------------------------------------
-// Opcode Implementations
+// Lazy Flags
 //-----------------------------------------------------------------------------
 
-//-- 8-Bit Load Opcodes --------------------------------------------------------
-
-// These operations are of the form LD R,n where R is a register and n is an
-// 8-bit immediate value that is loaded into R.
-
-void Cpu::Impl::Op_0006() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_000E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0016() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_001E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0026() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_002E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-// These Instructions are of the form LD r1,r2 where the value of register r2 is
-// loaded into the register r1.
-
-void Cpu::Impl::Op_007F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0078() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0079() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_007A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_007B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_007C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_007D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_007E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0040() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0041() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0042() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0043() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0044() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0045() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0046() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0048() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0049() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_004A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_004B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_004C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_004D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_004E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0050() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0051() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0052() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0053() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0054() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0055() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0056() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0058() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0059() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+// Flag-producing operations record their operands and full-width result
+// instead of updating F. Z, H and C are worked out from those only when
+// something reads F, and are dropped unread if a later operation overwrites
+// them all. Bit 4 (or 12) of left ^ right ^ result is the carry into that
+// bit, which gives H for addition and subtraction alike.
+
+//! \brief Record a flag-producing operation.
+//! \param mask the flags it writes
+inline void Cpu::Impl::deferFlags(uint8_t kind, uint8_t mask, uint16_t left, uint16_t right, uint32_t result) {
+        if (lazyMask & ~mask) {
+                materializeFlags();
+        }
+        lazyKind = kind;
+        lazyMask = mask;
+        lazyLeft = left;
+        lazyRight = right;
+        lazyResult = result;
 }
 
-void Cpu::Impl::Op_005A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+//! \brief Write flags in mask immediately.
+inline void Cpu::Impl::setFlags(uint8_t mask, uint8_t bits) {
+        if (lazyMask & ~mask) {
+                materializeFlags();
+        }
+        lazyMask = 0;
+        cpu->registers.r8.F = (cpu->registers.r8.F & ~mask) | bits;
 }
 
-void Cpu::Impl::Op_005B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//! \brief Bring registers.r8.F up to date.
+inline void Cpu::Impl::materializeFlags() {
+        if (0 == lazyMask) {
+                return;
+        }
 
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
+        uint32_t carries = lazyLeft ^ lazyRight ^ lazyResult;
+        uint8_t bits = 0;
+        switch (lazyKind) {
+                case LazySub:
+                        bits |= FlagN;
+                        // fall through
+                case LazyAdd:
+                        bits |= FlagIf(FlagZ, 0 == (lazyResult & 0xFF));
+                        bits |= FlagIf(FlagH, carries & 0x10);
+                        bits |= FlagIf(FlagC, lazyResult & 0x100);
+                        break;
+                case LazyLogic:
+                        bits |= FlagIf(FlagZ, 0 == lazyResult);
+                        break;
+                case LazyAdd16:
+                        bits |= FlagIf(FlagH, carries & 0x1000);
+                        bits |= FlagIf(FlagC, lazyResult & 0x10000);
+                        break;
+        }
 
-        LD();
+        cpu->registers.r8.F = (cpu->registers.r8.F & ~lazyMask) | (bits & lazyMask);
+        lazyMask = 0;
 }
 
-void Cpu::Impl::Op_005C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+//! \return up to date F
+inline uint8_t Cpu::Impl::flags() {
+        materializeFlags();
+        return cpu->registers.r8.F;
 }
 
-void Cpu::Impl::Op_005D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+inline bool Cpu::Impl::zeroFlag() {
+        if (lazyMask & FlagZ) {
+                return 0 == (lazyResult & 0xFF);
+        }
+        return cpu->registers.r8.F & FlagZ;
 }
 
-void Cpu::Impl::Op_005E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+inline bool Cpu::Impl::carryFlag() {
+        if (lazyMask & FlagC) {
+                return lazyResult & (LazyAdd16 == lazyKind ? 0x10000 : 0x100);
+        }
+        return cpu->registers.r8.F & FlagC;
 }
 
-void Cpu::Impl::Op_0060() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//-----------------------------------------------------------------------------
+// Memory Access
+//-----------------------------------------------------------------------------
 
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
+// An instruction's opcode and immediates take its first M-cycles; with
+// MCycleTiming runCycles() publishes the clock past them before running the
+// handler. Each read, write or internal M-cycle after that moves it on by
+// four more, so peripherals see the M-cycle an access happens in. FastTiming
+// handlers leave the clock alone.
 
-        LD();
+//! \brief Read addr, taking one M-cycle.
+template<typename Timing>
+inline uint8_t Cpu::Core<Timing>::read(uint16_t addr) {
+        uint8_t value = bus->read(addr);
+        tick();
+        return value;
 }
 
-void Cpu::Impl::Op_0061() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+//! \brief Write value to addr, taking one M-cycle.
+template<typename Timing>
+inline void Cpu::Core<Timing>::write(uint16_t addr, uint8_t value) {
+        bus->write(addr, value);
+        tick();
 }
 
-void Cpu::Impl::Op_0062() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+//! \brief End an M-cycle.
+template<typename Timing>
+inline void Cpu::Core<Timing>::tick() {
+        if (PerAccess) {
+                cpu->cycles += 4;
+        }
 }
 
-void Cpu::Impl::Op_0063() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+uint8_t TwosComplement(uint8_t num) {
+        return (~num) + 1;
 }
 
-void Cpu::Impl::Op_0064() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//! \brief Get the low or high nibble from byte
+//! \param byte value to get nibble from
+//! \param pos 0 for low nibble, 1 for high nibble.
+//! \return high or low nibble of byte as specified by pos
+uint8_t Nibble(uint8_t byte, uint8_t pos) {
+        uint8_t result;
 
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
+        if (pos) {
+                result = (byte & 0xF0) >> 4;
+        } else {
+                result = byte & 0x0F;
+        }
 
-        LD();
+        return result;
 }
 
-void Cpu::Impl::Op_0065() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
+//! \return 1 if parity is even, otherwise 0
+//! \see https://stackoverflow.com/a/21618038
+int Parity(uint8_t byte) {
+        byte ^= byte >> 4;
+        byte ^= byte >> 2;
+        byte ^= byte >> 1;
+        return (~byte) & 1;
 }
 
-void Cpu::Impl::Op_0066() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
+//-----------------------------------------------------------------------------
+// Operand Kinds
+//-----------------------------------------------------------------------------
 
-void Cpu::Impl::Op_0068() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+// An operand kind names where an opcode finds one of its operands. resolve()
+// performs any address calculation and returns one of the value types from
+// operand.hpp. Immediates are decoded before the handler runs; see decode().
+// Kinds are template arguments to the opcode handlers, so registers are
+// addressed by compile-time offset and every handler is its own fully
+// inlined specialization.
+
+//! \brief 8-bit register.
+template<uint8_t decltype(Cpu::registers.r8)::*R>
+struct Cpu::Impl::Reg8 {
+        static OperandReference resolve(Impl &impl) {
+                return OperandReference(impl.cpu->registers.r8.*R);
+        }
+};
 
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
+//! \brief 16-bit register pair.
+template<uint16_t decltype(Cpu::registers.r16)::*R>
+struct Cpu::Impl::Reg16 {
+        static OperandPairReference resolve(Impl &impl) {
+                if (R == &R16::AF) {
+                        impl.materializeFlags(); // PUSH AF reads F; POP AF replaces it.
+                }
+                return OperandPairReference(impl.cpu->registers.r16.*R);
+        }
+};
 
-        LD();
-}
+//! \brief Stack Pointer (SP).
+struct Cpu::Impl::RegSP {
+        static OperandPairReference resolve(Impl &impl) {
+                return OperandPairReference(impl.cpu->SP);
+        }
+};
 
-void Cpu::Impl::Op_0069() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//! \brief 8-bit immediate, #. Decoded ahead of execution into Impl::imm.
+struct Cpu::Impl::Imm8 {
+        static OperandValueByte resolve(Impl &impl) {
+                return OperandValueByte(static_cast<uint8_t>(impl.imm));
+        }
+};
 
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
+//! \brief 16-bit immediate, ##. Stored LSB first; decoded into Impl::imm.
+struct Cpu::Impl::Imm16 {
+        static OperandValueWord resolve(Impl &impl) {
+                return OperandValueWord(static_cast<uint16_t>(impl.imm));
+        }
+};
 
-        LD();
-}
+//! \brief Memory addressed by a register pair, eg. (HL).
+template<typename Timing>
+template<typename Pair>
+struct Cpu::Core<Timing>::Ind {
+        static OperandAddress<Core> resolve(Core &impl) {
+                return OperandAddress<Core>(Pair::resolve(impl).get(), &impl);
+        }
+};
 
-void Cpu::Impl::Op_006A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//! \brief (HL), incrementing HL afterwards. Used by LDI.
+template<typename Timing>
+struct Cpu::Core<Timing>::IndHLI {
+        static OperandAddress<Core> resolve(Core &impl) {
+                return OperandAddress<Core>(impl.cpu->registers.r16.HL++, &impl);
+        }
+};
 
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_006B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_006C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_006D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_006E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0070() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0071() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0072() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0073() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0074() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0075() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0036() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-// These Instructions are of the form LD A,n where A is the accumulator and n is
-// a register, immediate value or indirect value.
-
-void Cpu::Impl::Op_000A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.BC, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_001A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.DE, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_00FA() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint8_t lsb = bus->read(cpu->PC++);
-        uint8_t msb = bus->read(cpu->PC++);
-        uint16_t address = (msb << 8) | lsb;
-
-        auto op2 = std::make_shared<OperandAddress>(address, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_003E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-// These Instructions are of the form LD n,A where n is a register or indirect
-// address and the contents of the accumulator are copied into that.
-
-void Cpu::Impl::Op_0047() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_004F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0057() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_005F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0067() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_006F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0002() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.BC, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0012() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.DE, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_0077() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-void Cpu::Impl::Op_00EA() {
-        uint8_t lsb = bus->read(cpu->PC++);
-        uint8_t msb = bus->read(cpu->PC++);
-        uint16_t address = (msb << 8) | lsb;
-        auto op1 = std::make_shared<OperandAddress>(address, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LD A,(C)
-//!
-//! Put value at address $FF00 + register C into A. Same as: LD A,($FF00+C)
-void Cpu::Impl::Op_00F2() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint16_t address = static_cast<uint16_t>(cpu->registers.r8.C) + 0xFF00;
-        auto op2 = std::make_shared<OperandAddress>(address, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LD (C),A
-//!
-//! Put A into address $FF00 + register C.
-void Cpu::Impl::Op_00E2() {
-        uint16_t address = static_cast<uint16_t>(cpu->registers.r8.C) + 0xFF00;
-        auto op1 = std::make_shared<OperandAddress>(address, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LDD A,(HL)
-//!
-//! Put value at address HL into A. Decrement HL. Same as: LD A,(HL) - DEC HL
-void Cpu::Impl::Op_003A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-
-        cpu->registers.r16.HL--;
-}
-
-//! \brief LDD (HL),A
-//!
-//! Put A into memory address HL. Decrement HL. Same as: LD (HL),A - DEC HL
-void Cpu::Impl::Op_0032() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-
-        cpu->registers.r16.HL--;
-}
-
-//! \brief LDI A,(HL)
-//!
-//! Put value at address HL into A. Increment HL. Same as: LD A,(HL) - INC HL
-void Cpu::Impl::Op_002A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-
-        cpu->registers.r16.HL++;
-}
-
-//! \brief LDI (HL),A
-//!
-//! Put A into memory address HL. Increment HL. Same as: LD (HL),A - INC HL
-void Cpu::Impl::Op_0022() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-
-        cpu->registers.r16.HL++;
-}
-
-//! \brief LDH (n),A
-//!
-//! Put A into memory address $FF00+n
-void Cpu::Impl::Op_00E0() {
-        uint16_t address = bus->read(cpu->PC++) + 0xFF00;
-        auto op1 = std::make_shared<OperandAddress>(address, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LDH A,(n)
-//!
-//! Put memory address $FF00+n into A.
-void Cpu::Impl::Op_00F0() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint16_t address = bus->read(cpu->PC++) + 0xFF00;
-        auto op2 = std::make_shared<OperandAddress>(address, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//-- 16-Bit Load Opcodes -------------------------------------------------------
-
-//! \brief LD BC,##
-//!
-//! Put 16-bit value ## into register pair BC.
-void Cpu::Impl::Op_0001() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.BC);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op2 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LD DE,##
-//!
-//! Put 16-bit value ## into register pair DE.
-void Cpu::Impl::Op_0011() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.DE);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op2 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LD HL,##
-//!
-//! Put 16-bit value ## into register pair HL.
-void Cpu::Impl::Op_0021() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op2 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LD SP,##
-//!
-//! Put 16-bit value ## into Stack Pointer (SP).
-void Cpu::Impl::Op_0031() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->SP);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op2 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LD SP,HL
-//!
-//! Put HL into Stack Pointer (SP).
-void Cpu::Impl::Op_00F9() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->SP);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief LDHL SP,n
-//!
-//! Put SP + n effective address into HL.
-void Cpu::Impl::Op_00F8() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint16_t value = cpu->SP;
-        uint16_t byte = bus->read(cpu->PC++);
-        auto op2 = std::make_shared<OperandValueByte>(value + byte);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-
-        bool halfCarry = ((value & 0xFFF) + (byte & 0xFFF)) & 0x1000;
-        bool carry = ((uint32_t)value + (uint32_t)byte) & 0x10000;
-
-        cpu->flagSet('z', 0);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry);
-        cpu->flagSet('c', carry);
-}
-
-//! \brief LD (##),SP
-//!
-//! Put Stack Pointer (SP) at address ##.
-void Cpu::Impl::Op_0008() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandAddress>((hi << 8) + lo, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandPairReference>(cpu->SP);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        LD();
-}
-
-//! \brief PUSH AF
-//!
-//! Push register pair AF onto stack.  Decrement Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00F5() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.AF);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        PUSH();
-}
-
-//! \brief PUSH BC
-//!
-//! Push register pair BC onto stack.  Decrement Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00C5() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.BC);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        PUSH();
-}
-
-//! \brief PUSH DE
-//!
-//! Push register pair DE onto stack.  Decrement Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00D5() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.DE);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        PUSH();
-}
-
-//! \brief PUSH HL
-//!
-//! Push register pair HL onto stack.  Decrement Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00E5() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        PUSH();
-}
-
-//! \brief POP AF
-//!
-//! Pop two bytes off of the stack into AF. Increment Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00F1() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.AF);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        POP();
-}
-
-//! \brief POP BC
-//!
-//! Pop two bytes off of the stack into BC. Increment Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00C1() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.BC);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        POP();
-}
-
-//! \brief POP DE
-//!
-//! Pop two bytes off of the stack into DE. Increment Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00D1() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.DE);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        POP();
-}
-
-//! \brief POP HL
-//!
-//! Pop two bytes off of the stack into HL. Increment Stack Pointer (SP) twice.
-void Cpu::Impl::Op_00E1() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        POP();
-}
-
-//-- 8-Bit ALU Opcodes ---------------------------------------------------------
-
-//! \brief ADD A,A
-void Cpu::Impl::Op_0087() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,B
-void Cpu::Impl::Op_0080() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,C
-void Cpu::Impl::Op_0081() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,D
-void Cpu::Impl::Op_0082() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,E
-void Cpu::Impl::Op_0083() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,H
-void Cpu::Impl::Op_0084() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,L
-void Cpu::Impl::Op_0085() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,(HL)
-void Cpu::Impl::Op_0086() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADD A,#
-void Cpu::Impl::Op_00C6() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op2 = std::make_shared<OperandValueByte>(byte);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADD8();
-}
-
-//! \brief ADC A,A
-void Cpu::Impl::Op_008F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,B
-void Cpu::Impl::Op_0088() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,C
-void Cpu::Impl::Op_0089() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,D
-void Cpu::Impl::Op_008A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,E
-void Cpu::Impl::Op_008B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,H
-void Cpu::Impl::Op_008C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,L
-void Cpu::Impl::Op_008D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,(HL)
-void Cpu::Impl::Op_008E() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief ADC A,#
-void Cpu::Impl::Op_00CE() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op2 = std::make_shared<OperandValueByte>(byte);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        ADC8();
-}
-
-//! \brief SUB A
-void Cpu::Impl::Op_0097() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB B
-void Cpu::Impl::Op_0090() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB C
-void Cpu::Impl::Op_0091() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB D
-void Cpu::Impl::Op_0092() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB E
-void Cpu::Impl::Op_0093() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB H
-void Cpu::Impl::Op_0094() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB L
-void Cpu::Impl::Op_0095() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB (HL)
-void Cpu::Impl::Op_0096() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SUB #
-void Cpu::Impl::Op_00D6() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SUB8();
-}
-
-//! \brief SBC A
-void Cpu::Impl::Op_009F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief SBC B
-void Cpu::Impl::Op_0098() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief SBC C
-void Cpu::Impl::Op_0099() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief SBC D
-void Cpu::Impl::Op_009A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief SBC E
-void Cpu::Impl::Op_009B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief SBC H
-void Cpu::Impl::Op_009C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief SBC L
-void Cpu::Impl::Op_009D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief SBC (HL)
-void Cpu::Impl::Op_009E() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SBC8();
-}
-
-//! \brief AND A
-void Cpu::Impl::Op_00A7() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND B
-void Cpu::Impl::Op_00A0() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND C
-void Cpu::Impl::Op_00A1() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND D
-void Cpu::Impl::Op_00A2() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND E
-void Cpu::Impl::Op_00A3() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND H
-void Cpu::Impl::Op_00A4() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND L
-void Cpu::Impl::Op_00A5() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND (HL)
-void Cpu::Impl::Op_00A6() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief AND #
-void Cpu::Impl::Op_00E6() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        AND();
-}
-
-//! \brief OR A
-void Cpu::Impl::Op_00B7() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR B
-void Cpu::Impl::Op_00B0() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR C
-void Cpu::Impl::Op_00B1() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR D
-void Cpu::Impl::Op_00B2() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR E
-void Cpu::Impl::Op_00B3() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR H
-void Cpu::Impl::Op_00B4() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR L
-void Cpu::Impl::Op_00B5() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR (HL)
-void Cpu::Impl::Op_00B6() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief OR #
-void Cpu::Impl::Op_00F6() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        OR();
-}
-
-//! \brief XOR A
-void Cpu::Impl::Op_00AF() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR B
-void Cpu::Impl::Op_00A8() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR C
-void Cpu::Impl::Op_00A9() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR D
-void Cpu::Impl::Op_00AA() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR E
-void Cpu::Impl::Op_00AB() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR H
-void Cpu::Impl::Op_00AC() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR L
-void Cpu::Impl::Op_00AD() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR (HL)
-void Cpu::Impl::Op_00AE() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief XOR #
-void Cpu::Impl::Op_00EE() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        XOR();
-}
-
-//! \brief CP A
-void Cpu::Impl::Op_00BF() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP B
-void Cpu::Impl::Op_00B8() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP C
-void Cpu::Impl::Op_00B9() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP D
-void Cpu::Impl::Op_00BA() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP E
-void Cpu::Impl::Op_00BB() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP H
-void Cpu::Impl::Op_00BC() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP L
-void Cpu::Impl::Op_00BD() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP (HL)
-void Cpu::Impl::Op_00BE() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief CP #
-void Cpu::Impl::Op_00FE() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        CP();
-}
-
-//! \brief INC A
-void Cpu::Impl::Op_003C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief INC B
-void Cpu::Impl::Op_0004() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief INC C
-void Cpu::Impl::Op_000C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief INC D
-void Cpu::Impl::Op_0014() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief INC E
-void Cpu::Impl::Op_001C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief INC H
-void Cpu::Impl::Op_0024() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief INC L
-void Cpu::Impl::Op_002C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief INC (HL)
-void Cpu::Impl::Op_0034() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC8();
-}
-
-//! \brief DEC A
-void Cpu::Impl::Op_003D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//! \brief DEC B
-void Cpu::Impl::Op_0005() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//! \brief DEC C
-void Cpu::Impl::Op_000D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//! \brief DEC D
-void Cpu::Impl::Op_0015() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//! \brief DEC E
-void Cpu::Impl::Op_001D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//! \brief DEC H
-void Cpu::Impl::Op_0025() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//! \brief DEC L
-void Cpu::Impl::Op_002D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//! \brief DEC (HL)
-void Cpu::Impl::Op_0035() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC8();
-}
-
-//-- 16-Bit ALU Opcodes --------------------------------------------------------
-
-//! \brief ADD HL,BC
-void Cpu::Impl::Op_0009() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.BC);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        ADD16();
-}
-
-//! \brief ADD HL,DE
-void Cpu::Impl::Op_0019() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.DE);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        ADD16();
-}
-
-//! \brief ADD HL,HL
-void Cpu::Impl::Op_0029() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        ADD16();
-}
-
-//! \brief ADD HL,SP
-void Cpu::Impl::Op_0039() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->SP);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        ADD16();
-}
-
-//! \brief ADD SP,#
-void Cpu::Impl::Op_00E8() {
-        auto op1 = std::make_shared<OperandValueByte>(bus->read(cpu->PC++));
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        ADD16();
-}
-
-//! \brief INC BC
-void Cpu::Impl::Op_0003() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.BC);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC16();
-}
-
-//! \brief INC DE
-void Cpu::Impl::Op_0013() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.DE);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC16();
-}
-
-//! \brief INC HL
-void Cpu::Impl::Op_0023() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC16();
-}
-
-//! \brief INC SP
-void Cpu::Impl::Op_0033() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->SP);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        INC16();
-}
-
-//! \brief DEC BC
-void Cpu::Impl::Op_000B() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.BC);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC16();
-}
-
-//! \brief DEC DE
-void Cpu::Impl::Op_001B() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.DE);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC16();
-}
-
-//! \brief DEC HL
-void Cpu::Impl::Op_002B() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC16();
-}
-
-//! \brief DEC SP
-void Cpu::Impl::Op_003B() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->SP);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        DEC16();
-}
-
-//-- Miscellaneous Opcodes ----------------------------------------------------
-
-//! \brief SWAP A
-//!
-//! Swap upper and lower nibbles of specified register.
-void Cpu::Impl::Op_CB37() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief SWAP B
-//!
-//! Swap upper and lower nibbles of specified register.
-void Cpu::Impl::Op_CB30() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief SWAP C
-//!
-//! Swap upper and lower nibbles of specified register.
-void Cpu::Impl::Op_CB31() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief SWAP D
-//!
-//! Swap upper and lower nibbles of specified register.
-void Cpu::Impl::Op_CB32() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief SWAP E
-//!
-//! Swap upper and lower nibbles of specified register.
-void Cpu::Impl::Op_CB33() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief SWAP H
-//!
-//! Swap upper and lower nibbles of specified register.
-void Cpu::Impl::Op_CB34() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief SWAP L
-//!
-//! Swap upper and lower nibbles of specified register.
-void Cpu::Impl::Op_CB35() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief SWAP (HL)
-//!
-//! Swap upper and lower nibbles of value at address.
-void Cpu::Impl::Op_CB36() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SWAP();
-}
-
-//! \brief DAA
-//!
-//! Decimal adjust register A.
-void Cpu::Impl::Op_0027() {
-        DAA();
-}
-
-//! \brief CPL
-//!
-//! Complement register A.
-void Cpu::Impl::Op_002F() {
-        CPL();
-}
-
-//! \brief CCF
-//!
-//! Complement carry flag.
-void Cpu::Impl::Op_003F() {
-        CCF();
-}
-
-//! \brief SCF
-//!
-//! Set carry flag.
-void Cpu::Impl::Op_0037() {
-        SCF();
-}
-
-//! \brief NOP
-void Cpu::Impl::Op_0000() {
-        NOP();
-}
-
-//! \brief HALT
-//!
-//! Power down the CPU until an interrupt occurs.
-void Cpu::Impl::Op_0076() {
-        HALT();
-}
-
-//! \brief STOP
-//!
-//! Halt CPU & LCD display until a button is pressed.
-void Cpu::Impl::Op_1000() {
-        STOP();
-}
-
-//! \brief DI
-//!
-//! Disable interrupts.
-void Cpu::Impl::Op_00F3() {
-        DI();
-}
-
-//! \brief EI
-//!
-//! Enable interrupts.
-void Cpu::Impl::Op_00FB() {
-        EI();
-}
-
-//-- Rotate & Shift Opcodes ---------------------------------------------------
-
-//! \brief RLCA
-void Cpu::Impl::Op_0007() {
-        RLCA();
-}
-
-//! \brief RLA
-void Cpu::Impl::Op_0017() {
-        RLA();
-}
-
-//! \brief RRCA
-void Cpu::Impl::Op_000F() {
-        RRCA();
-}
-
-//! \brief RRA
-void Cpu::Impl::Op_001F() {
-        RRA();
-}
-
-//! \brief RLC A
-void Cpu::Impl::Op_CB07() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RLC B
-void Cpu::Impl::Op_CB00() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RLC C
-void Cpu::Impl::Op_CB01() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RLC D
-void Cpu::Impl::Op_CB02() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RLC E
-void Cpu::Impl::Op_CB03() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RLC H
-void Cpu::Impl::Op_CB04() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RLC L
-void Cpu::Impl::Op_CB05() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RLC (HL)
-void Cpu::Impl::Op_CB06() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RLC();
-}
-
-//! \brief RL A
-void Cpu::Impl::Op_CB17() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RL B
-void Cpu::Impl::Op_CB10() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RL C
-void Cpu::Impl::Op_CB11() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RL D
-void Cpu::Impl::Op_CB12() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RL E
-void Cpu::Impl::Op_CB13() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RL H
-void Cpu::Impl::Op_CB14() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RL L
-void Cpu::Impl::Op_CB15() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RL (HL)
-void Cpu::Impl::Op_CB16() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RL();
-}
-
-//! \brief RRC A
-void Cpu::Impl::Op_CB0F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RRC B
-void Cpu::Impl::Op_CB08() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RRC C
-void Cpu::Impl::Op_CB09() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RRC D
-void Cpu::Impl::Op_CB0A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RRC E
-void Cpu::Impl::Op_CB0B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RRC H
-void Cpu::Impl::Op_CB0C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RRC L
-void Cpu::Impl::Op_CB0D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RRC (HL)
-void Cpu::Impl::Op_CB0E() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RRC();
-}
-
-//! \brief RR A
-void Cpu::Impl::Op_CB1F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief RR B
-void Cpu::Impl::Op_CB18() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief RR C
-void Cpu::Impl::Op_CB19() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief RR D
-void Cpu::Impl::Op_CB1A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief RR E
-void Cpu::Impl::Op_CB1B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief RR H
-void Cpu::Impl::Op_CB1C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief RR L
-void Cpu::Impl::Op_CB1D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief RR (HL)
-void Cpu::Impl::Op_CB1E() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        RR();
-}
-
-//! \brief SLA A
-void Cpu::Impl::Op_CB27() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SLA B
-void Cpu::Impl::Op_CB20() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SLA C
-void Cpu::Impl::Op_CB21() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SLA D
-void Cpu::Impl::Op_CB22() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SLA E
-void Cpu::Impl::Op_CB23() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SLA H
-void Cpu::Impl::Op_CB24() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SLA L
-void Cpu::Impl::Op_CB25() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SLA (HL)
-void Cpu::Impl::Op_CB26() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SLA();
-}
-
-//! \brief SRA A
-void Cpu::Impl::Op_CB2F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRA B
-void Cpu::Impl::Op_CB28() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRA C
-void Cpu::Impl::Op_CB29() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRA D
-void Cpu::Impl::Op_CB2A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRA E
-void Cpu::Impl::Op_CB2B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRA H
-void Cpu::Impl::Op_CB2C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRA L
-void Cpu::Impl::Op_CB2D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRA (HL)
-void Cpu::Impl::Op_CB2E() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRA();
-}
-
-//! \brief SRL A
-void Cpu::Impl::Op_CB3F() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//! \brief SRL B
-void Cpu::Impl::Op_CB38() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//! \brief SRL C
-void Cpu::Impl::Op_CB39() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//! \brief SRL D
-void Cpu::Impl::Op_CB3A() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//! \brief SRL E
-void Cpu::Impl::Op_CB3B() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//! \brief SRL H
-void Cpu::Impl::Op_CB3C() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//! \brief SRL L
-void Cpu::Impl::Op_CB3D() {
-        auto op1 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//! \brief SRL (HL)
-void Cpu::Impl::Op_CB3E() {
-        auto op1 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        SRL();
-}
-
-//-- Bit Opcodes ---------------------------------------------------------------
-
-//! \brief BIT #,A
-void Cpu::Impl::Op_CB47() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief BIT #,B
-void Cpu::Impl::Op_CB40() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief BIT #,C
-void Cpu::Impl::Op_CB41() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief BIT #,D
-void Cpu::Impl::Op_CB42() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief BIT #,E
-void Cpu::Impl::Op_CB43() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief BIT #,H
-void Cpu::Impl::Op_CB44() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief BIT #,L
-void Cpu::Impl::Op_CB45() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief BIT #,(HL)
-void Cpu::Impl::Op_CB46() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        BIT();
-}
-
-//! \brief SET #,A
-void Cpu::Impl::Op_CBC7() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief SET #,B
-void Cpu::Impl::Op_CBC0() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief SET #,C
-void Cpu::Impl::Op_CBC1() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief SET #,D
-void Cpu::Impl::Op_CBC2() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief SET #,E
-void Cpu::Impl::Op_CBC3() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief SET #,H
-void Cpu::Impl::Op_CBC4() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief SET #,L
-void Cpu::Impl::Op_CBC5() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief SET #,(HL)
-void Cpu::Impl::Op_CBC6() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        SET();
-}
-
-//! \brief RES #,A
-void Cpu::Impl::Op_CB87() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.A);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        RES();
-}
-
-//! \brief RES #,B
-void Cpu::Impl::Op_CB80() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.B);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        RES();
-}
-
-//! \brief RES #,C
-void Cpu::Impl::Op_CB81() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.C);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        RES();
-}
-
-//! \brief RES #,D
-void Cpu::Impl::Op_CB82() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.D);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        RES();
-}
-
-//! \brief RES #,E
-void Cpu::Impl::Op_CB83() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.E);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        RES();
-}
-
-//! \brief RES #,H
-void Cpu::Impl::Op_CB84() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.H);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        RES();
-}
-
-//! \brief RES #,L
-void Cpu::Impl::Op_CB85() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
-
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        auto op2 = std::make_shared<OperandReference>(cpu->registers.r8.L);
-        operand2 = std::static_pointer_cast<Operand>(op2);
-
-        RES();
-}
-
-//! \brief RES #,(HL)
-void Cpu::Impl::Op_CB86() {
-        uint8_t byte = bus->read(cpu->PC++);
-        uint8_t bit = (byte >> 3) & 0x7;
+//! \brief (HL), decrementing HL afterwards. Used by LDD.
+template<typename Timing>
+struct Cpu::Core<Timing>::IndHLD {
+        static OperandAddress<Core> resolve(Core &impl) {
+                return OperandAddress<Core>(impl.cpu->registers.r16.HL--, &impl);
+        }
+};
 
-        auto op1 = std::make_shared<OperandValueByte>(bit);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//! \brief Memory addressed by a 16-bit immediate, (##).
+template<typename Timing>
+struct Cpu::Core<Timing>::IndImm16 {
+        static OperandAddress<Core> resolve(Core &impl) {
+                return OperandAddress<Core>(Imm16::resolve(impl).get(), &impl);
+        }
+};
 
-        auto op2 = std::make_shared<OperandAddress>(cpu->registers.r16.HL, bus);
-        operand2 = std::static_pointer_cast<Operand>(op2);
+//! \brief 16-bit word in memory addressed by a 16-bit immediate, (##).
+template<typename Timing>
+struct Cpu::Core<Timing>::IndImm16Word {
+        static OperandAddressWord<Core> resolve(Core &impl) {
+                return OperandAddressWord<Core>(Imm16::resolve(impl).get(), &impl);
+        }
+};
 
-        RES();
-}
+//! \brief High memory addressed by an 8-bit immediate, (0xFF00+#).
+template<typename Timing>
+struct Cpu::Core<Timing>::HighImm8 {
+        static OperandAddress<Core> resolve(Core &impl) {
+                return OperandAddress<Core>(0xFF00 + Imm8::resolve(impl).get(), &impl);
+        }
+};
 
-//-- Jump Opcodes --------------------------------------------------------------
+//! \brief High memory addressed by register C, (0xFF00+C).
+template<typename Timing>
+struct Cpu::Core<Timing>::HighC {
+        static OperandAddress<Core> resolve(Core &impl) {
+                return OperandAddress<Core>(0xFF00 + impl.cpu->registers.r8.C, &impl);
+        }
+};
 
-//! \brief JP ##
-void Cpu::Impl::Op_00C3() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//! \brief Constant encoded in the opcode itself; bit index or restart vector.
+template<uint16_t N>
+struct Cpu::Impl::Const {
+        static OperandValueWord resolve(Impl &) {
+                return OperandValueWord(N);
+        }
+};
 
-        JP();
-}
+//! \brief Maps the 3-bit register field used throughout the opcode space to
+//! its operand kind: B, C, D, E, H, L, (HL), A.
+template<typename Timing>
+template<unsigned int Index>
+struct Cpu::Core<Timing>::RegIndex {
+        using type = std::tuple_element_t<Index, std::tuple<
+                Reg8<&R8::B>, Reg8<&R8::C>, Reg8<&R8::D>, Reg8<&R8::E>,
+                Reg8<&R8::H>, Reg8<&R8::L>, Ind<Reg16<&R16::HL>>, Reg8<&R8::A>>>;
+};
 
-//! \brief JP NZ,##
-void Cpu::Impl::Op_00C2() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+struct Cpu::Impl::Always {
+        static const bool Conditional = false;
 
-        if (!cpu->flagGet('z')) {
-                JP();
+        static bool test(Impl &) {
+                return true;
         }
-}
+};
 
-//! \brief JP Z,##
-void Cpu::Impl::Op_00CA() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//! \brief Branch on Z ('z') or C ('c') being Set. Never materializes F.
+template<char Flag, bool Set>
+struct Cpu::Impl::Cond {
+        static_assert(Flag == 'z' || Flag == 'c', "only Z and C are tested");
+        static const bool Conditional = true;
 
-        if (cpu->flagGet('z')) {
-                JP();
+        static bool test(Impl &impl) {
+                return (Flag == 'z' ? impl.zeroFlag() : impl.carryFlag()) == Set;
         }
-}
+};
 
-//! \brief JP NC,##
-void Cpu::Impl::Op_00D2() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+//-----------------------------------------------------------------------------
+// Opcode Handlers
+//-----------------------------------------------------------------------------
 
-        if (!cpu->flagGet('c')) {
-                JP();
-        }
-}
+// Operands are resolved in order, destination first.
 
-//! \brief JP C,##
-void Cpu::Impl::Op_00DA() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Dst, typename Src>
+void Cpu::Core<Timing>::Op_LD() {
+        auto dst = Dst::resolve(*this);
+        auto src = Src::resolve(*this);
+        LD(dst, src);
+}
 
-        if (cpu->flagGet('c')) {
-                JP();
-        }
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_LDHL() {
+        LDHL(Src::resolve(*this));
 }
 
-//! \brief JP (HL)
-void Cpu::Impl::Op_00E9() {
-        auto op1 = std::make_shared<OperandPairReference>(cpu->registers.r16.HL);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_PUSH() {
+        PUSH(Src::resolve(*this));
+}
 
-        JP();
+template<typename Timing>
+template<typename Dst>
+void Cpu::Core<Timing>::Op_POP() {
+        POP(Dst::resolve(*this));
 }
 
-//! \brief JR #
-void Cpu::Impl::Op_0018() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_ADD8() {
+        ADD8(OperandReference(cpu->registers.r8.A), Src::resolve(*this));
+}
 
-        JR();
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_ADC8() {
+        ADC8(OperandReference(cpu->registers.r8.A), Src::resolve(*this));
 }
 
-//! \brief JR NZ,#
-void Cpu::Impl::Op_0020() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_SUB8() {
+        SUB8(Src::resolve(*this));
+}
 
-        if (!cpu->flagGet('z')) {
-                JR();
-        }
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_SBC8() {
+        SBC8(Src::resolve(*this));
 }
 
-//! \brief JR Z,#
-void Cpu::Impl::Op_0028() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_AND() {
+        AND(Src::resolve(*this));
+}
 
-        if (cpu->flagGet('z')) {
-                JR();
-        }
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_OR() {
+        OR(Src::resolve(*this));
 }
 
-//! \brief JR NC,#
-void Cpu::Impl::Op_0030() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_XOR() {
+        XOR(Src::resolve(*this));
+}
 
-        if (!cpu->flagGet('c')) {
-                JR();
-        }
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_CP() {
+        CP(Src::resolve(*this));
 }
 
-//! \brief JR C,#
-void Cpu::Impl::Op_0038() {
-        uint8_t byte = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueByte>(byte);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Dst>
+void Cpu::Core<Timing>::Op_INC8() {
+        INC8(Dst::resolve(*this));
+}
 
-        if (cpu->flagGet('c')) {
-                JR();
-        }
+template<typename Timing>
+template<typename Dst>
+void Cpu::Core<Timing>::Op_DEC8() {
+        DEC8(Dst::resolve(*this));
 }
 
-//-- Call Opcodes --------------------------------------------------------------
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_ADD16() {
+        ADD16(Src::resolve(*this));
+}
 
-//! \brief CALL ##
-void Cpu::Impl::Op_00CD() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::Op_ADDSP() {
+        ADDSP(Src::resolve(*this));
+}
 
-        CALL();
+template<typename Timing>
+template<typename Dst>
+void Cpu::Core<Timing>::Op_INC16() {
+        INC16(Dst::resolve(*this));
 }
 
-//! \brief CALL NZ,##
-void Cpu::Impl::Op_00C4() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
+template<typename Timing>
+template<typename Dst>
+void Cpu::Core<Timing>::Op_DEC16() {
+        DEC16(Dst::resolve(*this));
+}
 
-        if (!cpu->flagGet('z')) {
-                CALL();
+template<typename Timing>
+template<typename Cond, typename Src>
+void Cpu::Core<Timing>::Op_JP() {
+        auto address = Src::resolve(*this);
+        if (Cond::test(*this)) {
+                JP(address);
+                taken<Cond>(4);
         }
 }
 
-//! \brief CALL Z,##
-void Cpu::Impl::Op_00CC() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        if (cpu->flagGet('z')) {
-                CALL();
+template<typename Timing>
+template<typename Cond>
+void Cpu::Core<Timing>::Op_JR() {
+        auto offset = Imm8::resolve(*this);
+        if (Cond::test(*this)) {
+                JR(offset);
+                taken<Cond>(4);
         }
 }
 
-//! \brief CALL NC,##
-void Cpu::Impl::Op_00D4() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        if (!cpu->flagGet('c')) {
-                CALL();
+template<typename Timing>
+template<typename Cond>
+void Cpu::Core<Timing>::Op_CALL() {
+        auto address = Imm16::resolve(*this);
+        if (Cond::test(*this)) {
+                CALL(address);
+                taken<Cond>(12);
         }
 }
 
-//! \brief CALL C,##
-void Cpu::Impl::Op_00DC() {
-        uint16_t lo = bus->read(cpu->PC++);
-        uint16_t hi = bus->read(cpu->PC++);
-        auto op1 = std::make_shared<OperandValueWord>((hi << 8) | lo);
-        operand1 = std::static_pointer_cast<Operand>(op1);
-
-        if (cpu->flagGet('c')) {
-                CALL();
+template<typename Timing>
+template<typename Cond>
+void Cpu::Core<Timing>::Op_RET() {
+        if (Cond::Conditional) {
+                tick(); // testing the condition takes an M-cycle
+        }
+        if (Cond::test(*this)) {
+                RET();
+                taken<Cond>(12);
         }
 }
 
-//-- Restart Opcodes -----------------------------------------------------------
-
-// These Instructions are of the form RST n where the current address is pushed
-// onto the stack, then n specifies which address to jump to.
-
-//! \brief RST 0x00
-void Cpu::Impl::Op_00C7() {
-        auto op = std::make_shared<OperandAddress>(0x00, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
-
-        RST();
+//! \brief Charge the extra cycles of a conditional branch that was taken.
+//!
+//! The dispatch table holds the not-taken cost. Conditional branches always
+//! end a block, so runCycles() only needs to pick these up between blocks.
+template<typename Timing>
+template<typename Cond>
+void Cpu::Core<Timing>::taken(unsigned int extra) {
+        if (Cond::Conditional) {
+                takenCycles += extra;
+        }
 }
 
-//! \brief RST 0x08
-void Cpu::Impl::Op_00CF() {
-        auto op = std::make_shared<OperandAddress>(0x08, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
-
-        RST();
+template<typename Timing>
+template<uint16_t Vector>
+void Cpu::Core<Timing>::Op_RST() {
+        RST(Const<Vector>::resolve(*this));
 }
 
-//! \brief RST 0x10
-void Cpu::Impl::Op_00D7() {
-        auto op = std::make_shared<OperandAddress>(0x10, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
-
-        RST();
+//! \brief 0x40-0xBF: LD r,r' and the 8-bit ALU operations on A.
+//!
+//! Bits 0-2 select the source register, bits 3-5 select the destination
+//! register (LD) or the ALU operation.
+template<typename Timing>
+template<unsigned int Opcode>
+void Cpu::Core<Timing>::Op_Block() {
+        using Src = typename RegIndex<Opcode & 0x7>::type;
+        constexpr unsigned int y = (Opcode >> 3) & 0x7;
+
+        if constexpr (Opcode < 0x80) {
+                Op_LD<typename RegIndex<y>::type, Src>();
+        } else if constexpr (0 == y) {
+                Op_ADD8<Src>();
+        } else if constexpr (1 == y) {
+                Op_ADC8<Src>();
+        } else if constexpr (2 == y) {
+                Op_SUB8<Src>();
+        } else if constexpr (3 == y) {
+                Op_SBC8<Src>();
+        } else if constexpr (4 == y) {
+                Op_AND<Src>();
+        } else if constexpr (5 == y) {
+                Op_XOR<Src>();
+        } else if constexpr (6 == y) {
+                Op_OR<Src>();
+        } else {
+                Op_CP<Src>();
+        }
 }
 
-//! \brief RST 0x18
-void Cpu::Impl::Op_00DF() {
-        auto op = std::make_shared<OperandAddress>(0x18, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
-
-        RST();
+//! \brief 0xCB00-0xCBFF: rotates, shifts and bit operations.
+//!
+//! Bits 0-2 select the target register, bits 3-5 select the rotate/shift
+//! operation or the bit index, bits 6-7 select the operation group.
+template<typename Timing>
+template<unsigned int Opcode>
+void Cpu::Core<Timing>::Op_CB() {
+        auto target = RegIndex<Opcode & 0x7>::type::resolve(*this);
+        constexpr unsigned int y = (Opcode >> 3) & 0x7;
+        constexpr unsigned int x = Opcode >> 6;
+
+        if constexpr (1 == x) {
+                BIT(Const<y>::resolve(*this), target);
+        } else if constexpr (2 == x) {
+                RES(Const<y>::resolve(*this), target);
+        } else if constexpr (3 == x) {
+                SET(Const<y>::resolve(*this), target);
+        } else if constexpr (0 == y) {
+                RLC(target);
+        } else if constexpr (1 == y) {
+                RRC(target);
+        } else if constexpr (2 == y) {
+                RL(target);
+        } else if constexpr (3 == y) {
+                RR(target);
+        } else if constexpr (4 == y) {
+                SLA(target);
+        } else if constexpr (5 == y) {
+                SRA(target);
+        } else if constexpr (6 == y) {
+                SWAP(target);
+        } else {
+                SRL(target);
+        }
 }
 
-//! \brief RST 0x20
-void Cpu::Impl::Op_00E7() {
-        auto op = std::make_shared<OperandAddress>(0x20, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
-
-        RST();
+template<typename Timing>
+void Cpu::Core<Timing>::Op_Undefined() {
+        NOP();
 }
 
-//! \brief RST 0x28
-void Cpu::Impl::Op_00EF() {
-        auto op = std::make_shared<OperandAddress>(0x28, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
-
-        RST();
-}
+//-----------------------------------------------------------------------------
+// Opcode Function Mapping
+//-----------------------------------------------------------------------------
 
-//! \brief RST 0x30
-void Cpu::Impl::Op_00F7() {
-        auto op = std::make_shared<OperandAddress>(0x30, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
+//! \brief Append src to dst at pos, returning the new end position.
+static constexpr unsigned int Append(char *dst, unsigned int pos, const char *src) {
+        while (*src) {
+                dst[pos++] = *src++;
+        }
+        dst[pos] = '\0';
+        return pos;
+}
+
+//! \brief Build mnemonics for the generated regions of the dispatch table.
+constexpr Cpu::Impl::Mnemonics Cpu::Impl::MakeMnemonics() {
+        const char *regs[8] = { "B", "C", "D", "E", "H", "L", "(HL)", "A" };
+        const char *alu[8] = { "ADD A,", "ADC A,", "SUB ", "SBC A,", "AND ", "XOR ", "OR ", "CP " };
+        const char *rot[8] = { "RLC ", "RRC ", "RL ", "RR ", "SLA ", "SRA ", "SWAP ", "SRL " };
+        const char *bits[4] = { "", "BIT ", "RES ", "SET " };
+        const char *digits = "01234567";
+
+        Mnemonics m = {};
+        for (unsigned int op = 0x40; op < 0xC0; op++) {
+                char *s = m.text[op];
+                unsigned int pos = 0;
+                if (op < 0x80) {
+                        pos = Append(s, pos, "LD ");
+                        pos = Append(s, pos, regs[(op >> 3) & 0x7]);
+                        pos = Append(s, pos, ",");
+                } else {
+                        pos = Append(s, pos, alu[(op >> 3) & 0x7]);
+                }
+                Append(s, pos, regs[op & 0x7]);
+        }
+        for (unsigned int op = 0x00; op < 0x100; op++) {
+                char *s = m.text[0x100 | op];
+                unsigned int pos = 0;
+                if (op < 0x40) {
+                        pos = Append(s, pos, rot[(op >> 3) & 0x7]);
+                } else {
+                        pos = Append(s, pos, bits[op >> 6]);
+                        s[pos++] = digits[(op >> 3) & 0x7];
+                        pos = Append(s, pos, ",");
+                }
+                Append(s, pos, regs[op & 0x7]);
+        }
 
-        RST();
+        return m;
 }
 
-//! \brief RST 0x38
-void Cpu::Impl::Op_00FF() {
-        auto op = std::make_shared<OperandAddress>(0x38, bus);
-        operand1 = std::static_pointer_cast<Operand>(op);
-
-        RST();
-}
+constexpr Cpu::Impl::Mnemonics Cpu::Impl::mnemonics = Cpu::Impl::MakeMnemonics();
 
-//-- Returns -------------------------------------------------------------------
+//! \return encoded length in bytes of the instruction at dispatch table index
+constexpr unsigned int Cpu::Impl::InstructionLength(unsigned int index) {
+        if (index >= 0x100) {
+                return 2; // 0xCB prefix and opcode
+        }
 
-//! \brief RET
-void Cpu::Impl::Op_00C9() {
-        RET();
+        switch (index) {
+                case 0x01: case 0x11: case 0x21: case 0x31: case 0x08: // LD with ##
+                case 0xEA: case 0xFA:
+                case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA: // JP
+                case 0xCD: case 0xC4: case 0xCC: case 0xD4: case 0xDC: // CALL
+                        return 3;
+                case 0x06: case 0x0E: case 0x16: case 0x1E: // LD r,n
+                case 0x26: case 0x2E: case 0x36: case 0x3E:
+                case 0xE0: case 0xF0: case 0xE8: case 0xF8:
+                case 0xC6: case 0xCE: case 0xD6: case 0xDE: // ALU #
+                case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+                case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: // JR
+                case 0x10: // STOP is followed by a padding byte.
+                        return 2;
+                default:
+                        return 1;
+        }
 }
 
-//! \brief RET NZ
-void Cpu::Impl::Op_00C0() {
-        if (0 == cpu->flagGet('z')) {
-                RET();
+//! \return whether the instruction at dispatch table index may transfer
+//! control, or stop the CPU, and so must end a decoded block.
+constexpr bool Cpu::Impl::EndsBlock(unsigned int index) {
+        switch (index) {
+                case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: // JR
+                case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA: case 0xE9: // JP
+                case 0xCD: case 0xC4: case 0xCC: case 0xD4: case 0xDC: // CALL
+                case 0xC9: case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xD9: // RET
+                case 0xC7: case 0xCF: case 0xD7: case 0xDF: // RST
+                case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+                case 0x76: case 0x10: // HALT, STOP
+                case 0xFB: // EI; see Core::serviceInterrupts()
+                        return true;
+                default:
+                        return false;
         }
 }
 
-//! \brief RET Z
-void Cpu::Impl::Op_00C8() {
-        if (0 != cpu->flagGet('z')) {
-                RET();
-        }
+template<typename Timing>
+template<std::size_t... N>
+constexpr void Cpu::Core<Timing>::FillBlock(Table &t, std::index_sequence<N...>) {
+        // Any access through (HL) costs one extra memory cycle.
+        ((t[0x40 + N] = {
+                mnemonics.text[0x40 + N],
+                &Core::Op_Block<0x40 + N>,
+                (6 == ((0x40 + N) & 0x7) || (0x40 + N) / 8 == 0xE) ? 8u : 4u
+        }), ...);
 }
 
-//! \brief RET NC
-void Cpu::Impl::Op_00D0() {
-        if (0 == cpu->flagGet('c')) {
-                RET();
-        }
+template<typename Timing>
+template<std::size_t... N>
+constexpr void Cpu::Core<Timing>::FillCB(Table &t, std::index_sequence<N...>) {
+        // (HL) costs two extra memory cycles, or one for BIT which only reads.
+        ((t[0x100 | N] = {
+                mnemonics.text[0x100 | N],
+                &Core::Op_CB<N>,
+                6 != (N & 0x7) ? 8u : (1 == (N >> 6) ? 12u : 16u)
+        }), ...);
 }
 
-//! \brief RET C
-void Cpu::Impl::Op_00D8() {
-        if (0 != cpu->flagGet('c')) {
-                RET();
+//! \brief Build the flat dispatch table at compile time.
+//!
+//! Entries 0x000-0x0FF are the single-byte opcodes, entries 0x100-0x1FF are the
+//! 0xCB-prefixed opcodes.  Anything not listed decodes to Op_Undefined.
+//! 0x40-0xBF and the whole 0xCB block are regular and generated from the
+//! opcode bits; everything else is described by operation and operand kinds.
+//! Cycle counts are for the not-taken path of conditional branches.
+template<typename Timing>
+constexpr typename Cpu::Core<Timing>::Table Cpu::Core<Timing>::MakeInstructionTable() {
+        using A = Reg8<&R8::A>;
+        using B = Reg8<&R8::B>;
+        using C = Reg8<&R8::C>;
+        using D = Reg8<&R8::D>;
+        using E = Reg8<&R8::E>;
+        using H = Reg8<&R8::H>;
+        using L = Reg8<&R8::L>;
+        using AF = Reg16<&R16::AF>;
+        using BC = Reg16<&R16::BC>;
+        using DE = Reg16<&R16::DE>;
+        using HL = Reg16<&R16::HL>;
+        using SP = RegSP;
+        using IfNZ = Cond<'z', false>;
+        using IfZ = Cond<'z', true>;
+        using IfNC = Cond<'c', false>;
+        using IfC = Cond<'c', true>;
+
+        Table t = {};
+        for (auto &i : t) {
+                i = { "UNDEFINED", &Core::Op_Undefined, 4 };
         }
-}
 
-//! \brief RETI
-void Cpu::Impl::Op_00D9() {
-        RETI();
+        FillBlock(t, std::make_index_sequence<0x80>());
+        FillCB(t, std::make_index_sequence<0x100>());
+
+        // 8-bit Load
+        t[0x006] = { "LD B,n", &Core::Op_LD<B, Imm8>, 8 };
+        t[0x00E] = { "LD C,n", &Core::Op_LD<C, Imm8>, 8 };
+        t[0x016] = { "LD D,n", &Core::Op_LD<D, Imm8>, 8 };
+        t[0x01E] = { "LD E,n", &Core::Op_LD<E, Imm8>, 8 };
+        t[0x026] = { "LD H,n", &Core::Op_LD<H, Imm8>, 8 };
+        t[0x02E] = { "LD L,n", &Core::Op_LD<L, Imm8>, 8 };
+        t[0x036] = { "LD (HL),n", &Core::Op_LD<Ind<HL>, Imm8>, 12 };
+        t[0x03E] = { "LD A,n", &Core::Op_LD<A, Imm8>, 8 };
+        t[0x00A] = { "LD A,(BC)", &Core::Op_LD<A, Ind<BC>>, 8 };
+        t[0x01A] = { "LD A,(DE)", &Core::Op_LD<A, Ind<DE>>, 8 };
+        t[0x0FA] = { "LD A,(##)", &Core::Op_LD<A, IndImm16>, 16 };
+        t[0x002] = { "LD (BC),A", &Core::Op_LD<Ind<BC>, A>, 8 };
+        t[0x012] = { "LD (DE),A", &Core::Op_LD<Ind<DE>, A>, 8 };
+        t[0x0EA] = { "LD (##),A", &Core::Op_LD<IndImm16, A>, 16 };
+        t[0x0F2] = { "LD A,(0xFF00+C)", &Core::Op_LD<A, HighC>, 8 };
+        t[0x0E2] = { "LD (0xFF00+C),A", &Core::Op_LD<HighC, A>, 8 };
+        t[0x03A] = { "LDD A,(HL)", &Core::Op_LD<A, IndHLD>, 8 };
+        t[0x032] = { "LDD (HL),A", &Core::Op_LD<IndHLD, A>, 8 };
+        t[0x02A] = { "LDI A,(HL)", &Core::Op_LD<A, IndHLI>, 8 };
+        t[0x022] = { "LDI (HL),A", &Core::Op_LD<IndHLI, A>, 8 };
+        t[0x0E0] = { "LDH (0xFF00+n),A", &Core::Op_LD<HighImm8, A>, 12 };
+        t[0x0F0] = { "LDH A,(0xFF00+n)", &Core::Op_LD<A, HighImm8>, 12 };
+
+        // 16-bit Load
+        t[0x001] = { "LD BC,##", &Core::Op_LD<BC, Imm16>, 12 };
+        t[0x011] = { "LD DE,##", &Core::Op_LD<DE, Imm16>, 12 };
+        t[0x021] = { "LD HL,##", &Core::Op_LD<HL, Imm16>, 12 };
+        t[0x031] = { "LD SP,##", &Core::Op_LD<SP, Imm16>, 12 };
+        t[0x0F9] = { "LD SP,HL", &Core::Op_LD<SP, HL>, 8 };
+        t[0x0F8] = { "LDHL SP,n", &Core::Op_LDHL<Imm8>, 12 };
+        t[0x008] = { "LD (##),SP", &Core::Op_LD<IndImm16Word, SP>, 20 };
+        t[0x0F5] = { "PUSH AF", &Core::Op_PUSH<AF>, 16 };
+        t[0x0C5] = { "PUSH BC", &Core::Op_PUSH<BC>, 16 };
+        t[0x0D5] = { "PUSH DE", &Core::Op_PUSH<DE>, 16 };
+        t[0x0E5] = { "PUSH HL", &Core::Op_PUSH<HL>, 16 };
+        t[0x0F1] = { "POP AF", &Core::Op_POP<AF>, 12 };
+        t[0x0C1] = { "POP BC", &Core::Op_POP<BC>, 12 };
+        t[0x0D1] = { "POP DE", &Core::Op_POP<DE>, 12 };
+        t[0x0E1] = { "POP HL", &Core::Op_POP<HL>, 12 };
+
+        // 8-bit ALU
+        t[0x0C6] = { "ADD A,#", &Core::Op_ADD8<Imm8>, 8 };
+        t[0x0CE] = { "ADC A,#", &Core::Op_ADC8<Imm8>, 8 };
+        t[0x0D6] = { "SUB #", &Core::Op_SUB8<Imm8>, 8 };
+        t[0x0DE] = { "SBC A,#", &Core::Op_SBC8<Imm8>, 8 };
+        t[0x0E6] = { "AND #", &Core::Op_AND<Imm8>, 8 };
+        t[0x0F6] = { "OR #", &Core::Op_OR<Imm8>, 8 };
+        t[0x0EE] = { "XOR #", &Core::Op_XOR<Imm8>, 8 };
+        t[0x0FE] = { "CP #", &Core::Op_CP<Imm8>, 8 };
+        t[0x03C] = { "INC A", &Core::Op_INC8<A>, 4 };
+        t[0x004] = { "INC B", &Core::Op_INC8<B>, 4 };
+        t[0x00C] = { "INC C", &Core::Op_INC8<C>, 4 };
+        t[0x014] = { "INC D", &Core::Op_INC8<D>, 4 };
+        t[0x01C] = { "INC E", &Core::Op_INC8<E>, 4 };
+        t[0x024] = { "INC H", &Core::Op_INC8<H>, 4 };
+        t[0x02C] = { "INC L", &Core::Op_INC8<L>, 4 };
+        t[0x034] = { "INC (HL)", &Core::Op_INC8<Ind<HL>>, 12 };
+        t[0x03D] = { "DEC A", &Core::Op_DEC8<A>, 4 };
+        t[0x005] = { "DEC B", &Core::Op_DEC8<B>, 4 };
+        t[0x00D] = { "DEC C", &Core::Op_DEC8<C>, 4 };
+        t[0x015] = { "DEC D", &Core::Op_DEC8<D>, 4 };
+        t[0x01D] = { "DEC E", &Core::Op_DEC8<E>, 4 };
+        t[0x025] = { "DEC H", &Core::Op_DEC8<H>, 4 };
+        t[0x02D] = { "DEC L", &Core::Op_DEC8<L>, 4 };
+        t[0x035] = { "DEC (HL)", &Core::Op_DEC8<Ind<HL>>, 12 };
+
+        // 16-bit Arithmetic
+        t[0x009] = { "ADD HL,BC", &Core::Op_ADD16<BC>, 8 };
+        t[0x019] = { "ADD HL,DE", &Core::Op_ADD16<DE>, 8 };
+        t[0x029] = { "ADD HL,HL", &Core::Op_ADD16<HL>, 8 };
+        t[0x039] = { "ADD HL,SP", &Core::Op_ADD16<SP>, 8 };
+        t[0x0E8] = { "ADD SP,n", &Core::Op_ADDSP<Imm8>, 16 };
+        t[0x003] = { "INC BC", &Core::Op_INC16<BC>, 8 };
+        t[0x013] = { "INC DE", &Core::Op_INC16<DE>, 8 };
+        t[0x023] = { "INC HL", &Core::Op_INC16<HL>, 8 };
+        t[0x033] = { "INC SP", &Core::Op_INC16<SP>, 8 };
+        t[0x00B] = { "DEC BC", &Core::Op_DEC16<BC>, 8 };
+        t[0x01B] = { "DEC DE", &Core::Op_DEC16<DE>, 8 };
+        t[0x02B] = { "DEC HL", &Core::Op_DEC16<HL>, 8 };
+        t[0x03B] = { "DEC SP", &Core::Op_DEC16<SP>, 8 };
+
+        // Miscellaneous
+        t[0x027] = { "DAA", &Impl::DAA, 4 };
+        t[0x02F] = { "CPL", &Impl::CPL, 4 };
+        t[0x03F] = { "CCF", &Impl::CCF, 4 };
+        t[0x037] = { "SCF", &Impl::SCF, 4 };
+        t[0x000] = { "NOP", &Impl::NOP, 4 };
+        t[0x076] = { "HALT", &Impl::HALT, 4 };
+        t[0x010] = { "STOP", &Impl::STOP, 4 };
+        t[0x0F3] = { "DI", &Impl::DI, 4 };
+        t[0x0FB] = { "EI", &Impl::EI, 4 };
+
+        // Rotates and Shifts
+        t[0x007] = { "RLCA", &Impl::RLCA, 4 };
+        t[0x017] = { "RLA", &Impl::RLA, 4 };
+        t[0x00F] = { "RRCA", &Impl::RRCA, 4 };
+        t[0x01F] = { "RRA", &Impl::RRA, 4 };
+
+        // Jumps
+        t[0x0C3] = { "JP ##", &Core::Op_JP<Always, Imm16>, 16 };
+        t[0x0C2] = { "JP NZ,##", &Core::Op_JP<IfNZ, Imm16>, 12 };
+        t[0x0CA] = { "JP Z,##", &Core::Op_JP<IfZ, Imm16>, 12 };
+        t[0x0D2] = { "JP NC,##", &Core::Op_JP<IfNC, Imm16>, 12 };
+        t[0x0DA] = { "JP C,##", &Core::Op_JP<IfC, Imm16>, 12 };
+        t[0x0E9] = { "JP (HL)", &Core::Op_JP<Always, HL>, 4 };
+        t[0x018] = { "JR #", &Core::Op_JR<Always>, 12 };
+        t[0x020] = { "JR NZ,#", &Core::Op_JR<IfNZ>, 8 };
+        t[0x028] = { "JR Z,#", &Core::Op_JR<IfZ>, 8 };
+        t[0x030] = { "JR NC,#", &Core::Op_JR<IfNC>, 8 };
+        t[0x038] = { "JR C,#", &Core::Op_JR<IfC>, 8 };
+
+        // Calls
+        t[0x0CD] = { "CALL ##", &Core::Op_CALL<Always>, 24 };
+        t[0x0C4] = { "CALL NZ,##", &Core::Op_CALL<IfNZ>, 12 };
+        t[0x0CC] = { "CALL Z,##", &Core::Op_CALL<IfZ>, 12 };
+        t[0x0D4] = { "CALL NC,##", &Core::Op_CALL<IfNC>, 12 };
+        t[0x0DC] = { "CALL C,##", &Core::Op_CALL<IfC>, 12 };
+
+        // Restarts
+        t[0x0C7] = { "RST 0x00", &Core::Op_RST<0x00>, 16 };
+        t[0x0CF] = { "RST 0x08", &Core::Op_RST<0x08>, 16 };
+        t[0x0D7] = { "RST 0x10", &Core::Op_RST<0x10>, 16 };
+        t[0x0DF] = { "RST 0x18", &Core::Op_RST<0x18>, 16 };
+        t[0x0E7] = { "RST 0x20", &Core::Op_RST<0x20>, 16 };
+        t[0x0EF] = { "RST 0x28", &Core::Op_RST<0x28>, 16 };
+        t[0x0F7] = { "RST 0x30", &Core::Op_RST<0x30>, 16 };
+        t[0x0FF] = { "RST 0x38", &Core::Op_RST<0x38>, 16 };
+
+        // Returns
+        t[0x0C9] = { "RET", &Core::Op_RET<Always>, 16 };
+        t[0x0C0] = { "RET NZ", &Core::Op_RET<IfNZ>, 8 };
+        t[0x0C8] = { "RET Z", &Core::Op_RET<IfZ>, 8 };
+        t[0x0D0] = { "RET NC", &Core::Op_RET<IfNC>, 8 };
+        t[0x0D8] = { "RET C", &Core::Op_RET<IfC>, 8 };
+        t[0x0D9] = { "RETI", &Core::RETI, 16 };
+
+        for (unsigned int i = 0; i < t.size(); i++) {
+                t[i].length = InstructionLength(i);
+                t[i].endsBlock = EndsBlock(i);
+        }
+
+        return t;
 }
 
+template<typename Timing>
+constexpr typename Cpu::Core<Timing>::Table Cpu::Core<Timing>::instructionTable = MakeInstructionTable();
+
 //-----------------------------------------------------------------------------
-// Opcode Function Mapping
+// Superinstructions
 //-----------------------------------------------------------------------------
 
-void Cpu::Impl::InitInstructionMap() {
-        instructionMap = {
-                // 8-bit Load
-                { 0x0006, { "LD B,n",    &Cpu::Impl::Op_0006, 8 } },
-                { 0x000E, { "LD C,n",    &Cpu::Impl::Op_000E, 8 } },
-                { 0x0016, { "LD D,n",    &Cpu::Impl::Op_0016, 8 } },
-                { 0x001E, { "LD E,n",    &Cpu::Impl::Op_001E, 8 } },
-                { 0x0026, { "LD H,n",    &Cpu::Impl::Op_0026, 8 } },
-                { 0x002E, { "LD L,n",    &Cpu::Impl::Op_002E, 8 } },
-                { 0x007F, { "LD A,A",    &Cpu::Impl::Op_007F, 4 } },
-                { 0x0078, { "LD A,B",    &Cpu::Impl::Op_0078, 4 } },
-                { 0x0079, { "LD A,C",    &Cpu::Impl::Op_0079, 4 } },
-                { 0x007A, { "LD A,D",    &Cpu::Impl::Op_007A, 4 } },
-                { 0x007B, { "LD A,E",    &Cpu::Impl::Op_007B, 4 } },
-                { 0x007C, { "LD A,H",    &Cpu::Impl::Op_007C, 4 } },
-                { 0x007D, { "LD A,L",    &Cpu::Impl::Op_007D, 4 } },
-                { 0x007E, { "LD A,(HL)", &Cpu::Impl::Op_007E, 8 } },
-                { 0x0040, { "LD B,B",    &Cpu::Impl::Op_0040, 4 } },
-                { 0x0041, { "LD B,C",    &Cpu::Impl::Op_0041, 4 } },
-                { 0x0042, { "LD B,D",    &Cpu::Impl::Op_0042, 4 } },
-                { 0x0043, { "LD B,E",    &Cpu::Impl::Op_0043, 4 } },
-                { 0x0044, { "LD B,H",    &Cpu::Impl::Op_0044, 4 } },
-                { 0x0045, { "LD B,L",    &Cpu::Impl::Op_0045, 4 } },
-                { 0x0046, { "LD B,(HL)", &Cpu::Impl::Op_0046, 8 } },
-                { 0x0048, { "LD C,B",    &Cpu::Impl::Op_0048, 4 } },
-                { 0x0049, { "LD C,C",    &Cpu::Impl::Op_0049, 4 } },
-                { 0x004A, { "LD C,D",    &Cpu::Impl::Op_004A, 4 } },
-                { 0x004B, { "LD C,E",    &Cpu::Impl::Op_004B, 4 } },
-                { 0x004C, { "LD C,H",    &Cpu::Impl::Op_004C, 4 } },
-                { 0x004D, { "LD C,L",    &Cpu::Impl::Op_004D, 4 } },
-                { 0x004E, { "LD C,(HL)", &Cpu::Impl::Op_004E, 8 } },
-                { 0x0050, { "LD D,B",    &Cpu::Impl::Op_0050, 4 } },
-                { 0x0051, { "LD D,C",    &Cpu::Impl::Op_0051, 4 } },
-                { 0x0052, { "LD D,D",    &Cpu::Impl::Op_0052, 4 } },
-                { 0x0053, { "LD D,E",    &Cpu::Impl::Op_0053, 4 } },
-                { 0x0054, { "LD D,H",    &Cpu::Impl::Op_0054, 4 } },
-                { 0x0055, { "LD D,L",    &Cpu::Impl::Op_0055, 4 } },
-                { 0x0056, { "LD D,(HL)", &Cpu::Impl::Op_0056, 8 } },
-                { 0x0058, { "LD E,B",    &Cpu::Impl::Op_0058, 4 } },
-                { 0x0059, { "LD E,C",    &Cpu::Impl::Op_0059, 4 } },
-                { 0x005A, { "LD E,D",    &Cpu::Impl::Op_005A, 4 } },
-                { 0x005B, { "LD E,E",    &Cpu::Impl::Op_005B, 4 } },
-                { 0x005C, { "LD E,H",    &Cpu::Impl::Op_005C, 4 } },
-                { 0x005D, { "LD E,L",    &Cpu::Impl::Op_005D, 4 } },
-                { 0x005E, { "LD E,(HL)", &Cpu::Impl::Op_005E, 8 } },
-                { 0x0060, { "LD H,B",    &Cpu::Impl::Op_0060, 4 } },
-                { 0x0061, { "LD H,C",    &Cpu::Impl::Op_0061, 4 } },
-                { 0x0062, { "LD H,D",    &Cpu::Impl::Op_0062, 4 } },
-                { 0x0063, { "LD H,E",    &Cpu::Impl::Op_0063, 4 } },
-                { 0x0064, { "LD H,H",    &Cpu::Impl::Op_0064, 4 } },
-                { 0x0065, { "LD H,L",    &Cpu::Impl::Op_0065, 4 } },
-                { 0x0066, { "LD H,(HL)", &Cpu::Impl::Op_0066, 8 } },
-                { 0x0068, { "LD L,B",    &Cpu::Impl::Op_0068, 4 } },
-                { 0x0069, { "LD L,C",    &Cpu::Impl::Op_0069, 4 } },
-                { 0x006A, { "LD L,D",    &Cpu::Impl::Op_006A, 4 } },
-                { 0x006B, { "LD L,E",    &Cpu::Impl::Op_006B, 4 } },
-                { 0x006C, { "LD L,H",    &Cpu::Impl::Op_006C, 4 } },
-                { 0x006D, { "LD L,L",    &Cpu::Impl::Op_006D, 4 } },
-                { 0x006E, { "LD L,(HL)", &Cpu::Impl::Op_006E, 8 } },
-                { 0x0070, { "LD (HL),B", &Cpu::Impl::Op_0070, 8 } },
-                { 0x0071, { "LD (HL),C", &Cpu::Impl::Op_0071, 8 } },
-                { 0x0072, { "LD (HL),D", &Cpu::Impl::Op_0072, 8 } },
-                { 0x0073, { "LD (HL),E", &Cpu::Impl::Op_0073, 8 } },
-                { 0x0074, { "LD (HL),H", &Cpu::Impl::Op_0074, 8 } },
-                { 0x0075, { "LD (HL),L", &Cpu::Impl::Op_0075, 8 } },
-                { 0x0036, { "LD (HL),n", &Cpu::Impl::Op_0036, 12 } },
-                { 0x007F, { "LD A,A",    &Cpu::Impl::Op_007F, 4 } },
-                { 0x000A, { "LD A,(BC)", &Cpu::Impl::Op_000A, 8 } },
-                { 0x001A, { "LD A,(DE)", &Cpu::Impl::Op_001A, 8 } },
-                { 0x00FA, { "LD A,(##)", &Cpu::Impl::Op_00FA, 16 } },
-                { 0x003E, { "LD A,n",    &Cpu::Impl::Op_003E, 8 } },
-                { 0x0047, { "LD A,B",    &Cpu::Impl::Op_0047, 4 } },
-                { 0x004F, { "LD A,C",    &Cpu::Impl::Op_004F, 4 } },
-                { 0x0057, { "LD A,D",    &Cpu::Impl::Op_0057, 4 } },
-                { 0x005F, { "LD A,E",    &Cpu::Impl::Op_005F, 4 } },
-                { 0x0067, { "LD A,H",    &Cpu::Impl::Op_0067, 4 } },
-                { 0x006F, { "LD A,L",    &Cpu::Impl::Op_006F, 4 } },
-                { 0x0002, { "LD (BC),A", &Cpu::Impl::Op_0002, 8 } },
-                { 0x0012, { "LD (DE),A", &Cpu::Impl::Op_0002, 8 } },
-                { 0x007E, { "LD (HL),A", &Cpu::Impl::Op_007E, 8 } },
-                { 0x00FA, { "LD (##),A", &Cpu::Impl::Op_00FA, 16 } },
-                { 0x00F2, { "LDH A,(0x00FF00+C)", &Cpu::Impl::Op_00F2, 8 } },
-                { 0x00E2, { "LDH (0x00FF00+C),A", &Cpu::Impl::Op_00E2, 8 } },
-                { 0x003A, { "LDD A,(HL)", &Cpu::Impl::Op_003A, 8 } },
-                { 0x0032, { "LDD (HL),A", &Cpu::Impl::Op_0032, 8 } },
-                { 0x002A, { "LDI A,(HL)", &Cpu::Impl::Op_002A, 8 } },
-                { 0x0022, { "LDI (HL),A", &Cpu::Impl::Op_0022, 8 } },
-                { 0x002A, { "LDH (0x00FF00+n),A", &Cpu::Impl::Op_002A, 12 } },
-                { 0x0022, { "LDH A,(0x00FF00+n)", &Cpu::Impl::Op_0022, 12 } },
-
-                // 16-bit Load
-                { 0x0001, { "LD BC,##", &Cpu::Impl::Op_0001, 12 } },
-                { 0x0011, { "LD DE,##", &Cpu::Impl::Op_0011, 12 } },
-                { 0x0021, { "LD HL,##", &Cpu::Impl::Op_0021, 12 } },
-                { 0x0031, { "LD SP,##", &Cpu::Impl::Op_0031, 12 } },
-                { 0x00F9, { "LD SP,HL", &Cpu::Impl::Op_00F9, 8 } },
-                { 0x00F8, { "LDHL SP,n", &Cpu::Impl::Op_00F8, 12 } },
-                { 0x0008, { "LD (##),SP", &Cpu::Impl::Op_0008, 20 } },
-                { 0x00F5, { "PUSH AF", &Cpu::Impl::Op_00F5, 16 } },
-                { 0x00C5, { "PUSH BC", &Cpu::Impl::Op_00C5, 16 } },
-                { 0x00D5, { "PUSH DE", &Cpu::Impl::Op_00D5, 16 } },
-                { 0x00E5, { "PUSH HL", &Cpu::Impl::Op_00E5, 16 } },
-                { 0x00F1, { "POP AF", &Cpu::Impl::Op_00F1, 12 } },
-                { 0x00C1, { "POP BC", &Cpu::Impl::Op_00C1, 12 } },
-                { 0x00D1, { "POP DE", &Cpu::Impl::Op_00D1, 12 } },
-                { 0x00E1, { "POP HL", &Cpu::Impl::Op_00E1, 12 } },
-
-                // 8-bit ALU
-                { 0x0087, { "ADD A,A", &Cpu::Impl::Op_0087, 4 } },
-                { 0x0080, { "ADD A,B", &Cpu::Impl::Op_0080, 4 } },
-                { 0x0081, { "ADD A,C", &Cpu::Impl::Op_0081, 4 } },
-                { 0x0082, { "ADD A,D", &Cpu::Impl::Op_0082, 4 } },
-                { 0x0083, { "ADD A,E", &Cpu::Impl::Op_0083, 4 } },
-                { 0x0084, { "ADD A,H", &Cpu::Impl::Op_0084, 4 } },
-                { 0x0085, { "ADD A,L", &Cpu::Impl::Op_0085, 4 } },
-                { 0x0086, { "ADD A,(HL)", &Cpu::Impl::Op_0086, 8 } },
-                { 0x00C6, { "ADD A,##", &Cpu::Impl::Op_00C6, 8 } },
-
-                { 0x008F, { "ADC A,A", &Cpu::Impl::Op_008F, 4 } },
-                { 0x0088, { "ADC A,B", &Cpu::Impl::Op_0088, 4 } },
-                { 0x0089, { "ADC A,C", &Cpu::Impl::Op_0089, 4 } },
-                { 0x008A, { "ADC A,D", &Cpu::Impl::Op_008A, 4 } },
-                { 0x008B, { "ADC A,E", &Cpu::Impl::Op_008B, 4 } },
-                { 0x008C, { "ADC A,H", &Cpu::Impl::Op_008C, 4 } },
-                { 0x008D, { "ADC A,L", &Cpu::Impl::Op_008D, 4 } },
-                { 0x008E, { "ADC A,(HL)", &Cpu::Impl::Op_008E, 8 } },
-                { 0x00CE, { "ADC A,##", &Cpu::Impl::Op_00CE, 8 } },
-
-                { 0x0097, { "SUB A", &Cpu::Impl::Op_0097, 4 } },
-                { 0x0090, { "SUB B", &Cpu::Impl::Op_0090, 4 } },
-                { 0x0091, { "SUB C", &Cpu::Impl::Op_0091, 4 } },
-                { 0x0092, { "SUB D", &Cpu::Impl::Op_0092, 4 } },
-                { 0x0093, { "SUB E", &Cpu::Impl::Op_0093, 4 } },
-                { 0x0094, { "SUB H", &Cpu::Impl::Op_0094, 4 } },
-                { 0x0095, { "SUB L", &Cpu::Impl::Op_0095, 4 } },
-                { 0x0096, { "SUB (HL)", &Cpu::Impl::Op_0096, 8 } },
-                { 0x00D6, { "SUB ##", &Cpu::Impl::Op_00D6, 8 } },
-
-                { 0x009F, { "SBC A,A", &Cpu::Impl::Op_009F, 4 } },
-                { 0x0098, { "SBC A,B", &Cpu::Impl::Op_0098, 4 } },
-                { 0x0099, { "SBC A,C", &Cpu::Impl::Op_0099, 4 } },
-                { 0x009A, { "SBC A,D", &Cpu::Impl::Op_009A, 4 } },
-                { 0x009B, { "SBC A,E", &Cpu::Impl::Op_009B, 4 } },
-                { 0x009C, { "SBC A,H", &Cpu::Impl::Op_009C, 4 } },
-                { 0x009D, { "SBC A,L", &Cpu::Impl::Op_009D, 4 } },
-                { 0x009E, { "SBC A,(HL)", &Cpu::Impl::Op_009E, 8 } },
-
-                { 0x00A7, { "AND A", &Cpu::Impl::Op_00A7, 4 } },
-                { 0x00A0, { "AND B", &Cpu::Impl::Op_00A0, 4 } },
-                { 0x00A1, { "AND C", &Cpu::Impl::Op_00A1, 4 } },
-                { 0x00A2, { "AND D", &Cpu::Impl::Op_00A2, 4 } },
-                { 0x00A3, { "AND E", &Cpu::Impl::Op_00A3, 4 } },
-                { 0x00A4, { "AND H", &Cpu::Impl::Op_00A4, 4 } },
-                { 0x00A5, { "AND L", &Cpu::Impl::Op_00A5, 4 } },
-                { 0x00A6, { "AND (HL)", &Cpu::Impl::Op_00A6, 8 } },
-                { 0x00E6, { "AND ##", &Cpu::Impl::Op_00E6, 8 } },
-
-                { 0x00B7, { "OR A", &Cpu::Impl::Op_00B7, 4 } },
-                { 0x00B0, { "OR B", &Cpu::Impl::Op_00B0, 4 } },
-                { 0x00B1, { "OR C", &Cpu::Impl::Op_00B1, 4 } },
-                { 0x00B2, { "OR D", &Cpu::Impl::Op_00B2, 4 } },
-                { 0x00B3, { "OR E", &Cpu::Impl::Op_00B3, 4 } },
-                { 0x00B4, { "OR H", &Cpu::Impl::Op_00B4, 4 } },
-                { 0x00B5, { "OR L", &Cpu::Impl::Op_00B5, 4 } },
-                { 0x00B6, { "OR (HL)", &Cpu::Impl::Op_00B6, 8 } },
-                { 0x00F6, { "OR ##", &Cpu::Impl::Op_00F6, 8 } },
-
-                { 0x00AF, { "XOR A", &Cpu::Impl::Op_00AF, 4 } },
-                { 0x00A8, { "XOR B", &Cpu::Impl::Op_00A8, 4 } },
-                { 0x00A9, { "XOR C", &Cpu::Impl::Op_00A9, 4 } },
-                { 0x00AA, { "XOR D", &Cpu::Impl::Op_00AA, 4 } },
-                { 0x00AB, { "XOR E", &Cpu::Impl::Op_00AB, 4 } },
-                { 0x00AC, { "XOR H", &Cpu::Impl::Op_00AC, 4 } },
-                { 0x00AD, { "XOR L", &Cpu::Impl::Op_00AD, 4 } },
-                { 0x00AE, { "XOR (HL)", &Cpu::Impl::Op_00AE, 8 } },
-                { 0x00EE, { "XOR ##", &Cpu::Impl::Op_00EE, 8 } },
-
-                { 0x00BF, { "CP A", &Cpu::Impl::Op_00BF, 4 } },
-                { 0x00B8, { "CP B", &Cpu::Impl::Op_00B8, 4 } },
-                { 0x00B9, { "CP C", &Cpu::Impl::Op_00B9, 4 } },
-                { 0x00BA, { "CP D", &Cpu::Impl::Op_00BA, 4 } },
-                { 0x00BB, { "CP E", &Cpu::Impl::Op_00BB, 4 } },
-                { 0x00BC, { "CP H", &Cpu::Impl::Op_00BC, 4 } },
-                { 0x00BD, { "CP L", &Cpu::Impl::Op_00BD, 4 } },
-                { 0x00BE, { "CP (HL)", &Cpu::Impl::Op_00BE, 8 } },
-                { 0x00FE, { "CP ##", &Cpu::Impl::Op_00FE, 8 } },
-
-                { 0x003C, { "INC A", &Cpu::Impl::Op_003C, 4 } },
-                { 0x0004, { "INC B", &Cpu::Impl::Op_0004, 4 } },
-                { 0x000C, { "INC C", &Cpu::Impl::Op_000C, 4 } },
-                { 0x0014, { "INC D", &Cpu::Impl::Op_0014, 4 } },
-                { 0x001C, { "INC E", &Cpu::Impl::Op_001C, 4 } },
-                { 0x0024, { "INC H", &Cpu::Impl::Op_0024, 4 } },
-                { 0x002C, { "INC L", &Cpu::Impl::Op_002C, 4 } },
-                { 0x0034, { "INC (HL)", &Cpu::Impl::Op_0034, 12 } },
-
-                { 0x003D, { "DEC A", &Cpu::Impl::Op_003D, 4 } },
-                { 0x0005, { "DEC B", &Cpu::Impl::Op_0005, 4 } },
-                { 0x000D, { "DEC C", &Cpu::Impl::Op_000D, 4 } },
-                { 0x0015, { "DEC D", &Cpu::Impl::Op_0015, 4 } },
-                { 0x001D, { "DEC E", &Cpu::Impl::Op_001D, 4 } },
-                { 0x0025, { "DEC H", &Cpu::Impl::Op_0025, 4 } },
-                { 0x002D, { "DEC L", &Cpu::Impl::Op_002D, 4 } },
-                { 0x0035, { "DEC (HL)", &Cpu::Impl::Op_0035, 12 } },
-
-                // 16-bit Arithmetic
-                { 0x0009, { "ADD HL,BC", &Cpu::Impl::Op_0009, 8 } },
-                { 0x0019, { "ADD HL,DE", &Cpu::Impl::Op_0019, 8 } },
-                { 0x0029, { "ADD HL,HL", &Cpu::Impl::Op_0029, 8 } },
-                { 0x0039, { "ADD HL,SP", &Cpu::Impl::Op_0039, 8 } },
-                { 0x00E8, { "ADD SP,n",  &Cpu::Impl::Op_00E8, 16 } },
-
-                { 0x000B, { "DEC BC", &Cpu::Impl::Op_000B, 8 } },
-                { 0x001B, { "DEC DE", &Cpu::Impl::Op_001B, 8 } },
-                { 0x002B, { "DEC HL", &Cpu::Impl::Op_002B, 8 } },
-                { 0x003B, { "DEC SP", &Cpu::Impl::Op_003B, 8 } },
-
-                // Miscellaneous
-                { 0x0037, { "SWAP A",    &Cpu::Impl::Op_0037, 8 } },
-                { 0x0030, { "SWAP B",    &Cpu::Impl::Op_0030, 8 } },
-                { 0x0031, { "SWAP C",    &Cpu::Impl::Op_0031, 8 } },
-                { 0x0032, { "SWAP D",    &Cpu::Impl::Op_0032, 8 } },
-                { 0x0033, { "SWAP E",    &Cpu::Impl::Op_0033, 8 } },
-                { 0x0034, { "SWAP H",    &Cpu::Impl::Op_0034, 8 } },
-                { 0x0035, { "SWAP L",    &Cpu::Impl::Op_0035, 8 } },
-                { 0x0036, { "SWAP (HL)", &Cpu::Impl::Op_0036, 16 } },
-
-                { 0x0027, { "DAA",  &Cpu::Impl::Op_0027, 4 } },
-                { 0x002F, { "CPL",  &Cpu::Impl::Op_002F, 4 } },
-                { 0x003F, { "CCF",  &Cpu::Impl::Op_003F, 4 } },
-                { 0x0037, { "SCF",  &Cpu::Impl::Op_0037, 4 } },
-                { 0x0000, { "NOP",  &Cpu::Impl::Op_0000, 4 } },
-                { 0x0076, { "HALT", &Cpu::Impl::Op_0076, 4 } },
-                { 0x1000, { "STOP", &Cpu::Impl::Op_1000, 4 } },
-                { 0x00F3, { "DI",   &Cpu::Impl::Op_00F3, 4 } },
-                { 0x00FB, { "EI",   &Cpu::Impl::Op_00FB, 4 } },
-
-                // Rotates and Shifts
-                { 0x0007, { "RLCA", &Cpu::Impl::Op_0007, 4 } },
-                { 0x0017, { "RLA",  &Cpu::Impl::Op_0017,  4 } },
-                { 0x000F, { "RRCA", &Cpu::Impl::Op_000F, 4 } },
-                { 0x001F, { "RRA",  &Cpu::Impl::Op_001F,  4 } },
-
-                { 0xCB07, { "RLC A",    &Cpu::Impl::Op_CB07, 8 } },
-                { 0xCB00, { "RLC B",    &Cpu::Impl::Op_CB00, 8 } },
-                { 0xCB01, { "RLC C",    &Cpu::Impl::Op_CB01, 8 } },
-                { 0xCB02, { "RLC D",    &Cpu::Impl::Op_CB02, 8 } },
-                { 0xCB03, { "RLC E",    &Cpu::Impl::Op_CB03, 8 } },
-                { 0xCB04, { "RLC H",    &Cpu::Impl::Op_CB04, 8 } },
-                { 0xCB05, { "RLC L",    &Cpu::Impl::Op_CB05, 8 } },
-                { 0xCB06, { "RLC (HL)", &Cpu::Impl::Op_CB06, 16 } },
-
-                { 0xCB17, { "RL A",    &Cpu::Impl::Op_CB17, 8 } },
-                { 0xCB10, { "RL B",    &Cpu::Impl::Op_CB10, 8 } },
-                { 0xCB11, { "RL C",    &Cpu::Impl::Op_CB11, 8 } },
-                { 0xCB12, { "RL D",    &Cpu::Impl::Op_CB12, 8 } },
-                { 0xCB13, { "RL E",    &Cpu::Impl::Op_CB13, 8 } },
-                { 0xCB14, { "RL H",    &Cpu::Impl::Op_CB14, 8 } },
-                { 0xCB15, { "RL L",    &Cpu::Impl::Op_CB15, 8 } },
-                { 0xCB16, { "RL (HL)", &Cpu::Impl::Op_CB16, 16 } },
-
-                { 0xCB0F, { "RRC A", &Cpu::Impl::Op_CB0F, 8 } },
-                { 0xCB08, { "RRC B", &Cpu::Impl::Op_CB08, 8 } },
-                { 0xCB09, { "RRC C", &Cpu::Impl::Op_CB09, 8 } },
-                { 0xCB0A, { "RRC D", &Cpu::Impl::Op_CB0A, 8 } },
-                { 0xCB0B, { "RRC E", &Cpu::Impl::Op_CB0B, 8 } },
-                { 0xCB0C, { "RRC H", &Cpu::Impl::Op_CB0C, 8 } },
-                { 0xCB0D, { "RRC L", &Cpu::Impl::Op_CB0D, 8 } },
-                { 0xCB0E, { "RRC (HL)", &Cpu::Impl::Op_CB0E, 16 } },
-
-                { 0xCB1F, { "RR A", &Cpu::Impl::Op_CB1F, 8 } },
-                { 0xCB18, { "RR B", &Cpu::Impl::Op_CB18, 8 } },
-                { 0xCB19, { "RR C", &Cpu::Impl::Op_CB19, 8 } },
-                { 0xCB1A, { "RR D", &Cpu::Impl::Op_CB1A, 8 } },
-                { 0xCB1B, { "RR E", &Cpu::Impl::Op_CB1B, 8 } },
-                { 0xCB1C, { "RR H", &Cpu::Impl::Op_CB1C, 8 } },
-                { 0xCB1D, { "RR L", &Cpu::Impl::Op_CB1D, 8 } },
-                { 0xCB1E, { "RR (HL)", &Cpu::Impl::Op_CB1E, 16 } },
-
-                { 0xCB27, { "SLA A", &Cpu::Impl::Op_CB27, 8 } },
-                { 0xCB20, { "SLA B", &Cpu::Impl::Op_CB20, 8 } },
-                { 0xCB21, { "SLA C", &Cpu::Impl::Op_CB21, 8 } },
-                { 0xCB22, { "SLA D", &Cpu::Impl::Op_CB22, 8 } },
-                { 0xCB23, { "SLA E", &Cpu::Impl::Op_CB23, 8 } },
-                { 0xCB24, { "SLA H", &Cpu::Impl::Op_CB24, 8 } },
-                { 0xCB25, { "SLA L", &Cpu::Impl::Op_CB25, 8 } },
-                { 0xCB26, { "SLA (HL)", &Cpu::Impl::Op_CB26, 16 } },
-
-                { 0xCB2F, { "SRA A", &Cpu::Impl::Op_CB2F, 8 } },
-                { 0xCB28, { "SRA B", &Cpu::Impl::Op_CB28, 8 } },
-                { 0xCB29, { "SRA C", &Cpu::Impl::Op_CB29, 8 } },
-                { 0xCB2A, { "SRA D", &Cpu::Impl::Op_CB2A, 8 } },
-                { 0xCB2B, { "SRA E", &Cpu::Impl::Op_CB2B, 8 } },
-                { 0xCB2C, { "SRA H", &Cpu::Impl::Op_CB2C, 8 } },
-                { 0xCB2D, { "SRA L", &Cpu::Impl::Op_CB2D, 8 } },
-                { 0xCB2E, { "SRA (HL)", &Cpu::Impl::Op_CB2E, 16 } },
-
-                { 0xCB3F, { "SRL A", &Cpu::Impl::Op_CB3F, 8 } },
-                { 0xCB38, { "SRL B", &Cpu::Impl::Op_CB38, 8 } },
-                { 0xCB39, { "SRL C", &Cpu::Impl::Op_CB39, 8 } },
-                { 0xCB3A, { "SRL D", &Cpu::Impl::Op_CB3A, 8 } },
-                { 0xCB3B, { "SRL E", &Cpu::Impl::Op_CB3B, 8 } },
-                { 0xCB3C, { "SRL H", &Cpu::Impl::Op_CB3C, 8 } },
-                { 0xCB3D, { "SRL L", &Cpu::Impl::Op_CB3D, 8 } },
-                { 0xCB3E, { "SRL (HL)", &Cpu::Impl::Op_CB3E, 16 } },
-
-                // Bit Operations
-                { 0xCB47, { "BIT b,A",    &Cpu::Impl::Op_CB47, 8 } },
-                { 0xCB40, { "BIT b,B",    &Cpu::Impl::Op_CB40, 8 } },
-                { 0xCB41, { "BIT b,C",    &Cpu::Impl::Op_CB41, 8 } },
-                { 0xCB42, { "BIT b,D",    &Cpu::Impl::Op_CB42, 8 } },
-                { 0xCB43, { "BIT b,E",    &Cpu::Impl::Op_CB43, 8 } },
-                { 0xCB44, { "BIT b,H",    &Cpu::Impl::Op_CB44, 8 } },
-                { 0xCB45, { "BIT b,L",    &Cpu::Impl::Op_CB45, 8 } },
-                { 0xCB46, { "BIT b,(HL)", &Cpu::Impl::Op_CB46, 16 } },
-
-                { 0xCBC7, { "SET b,A",    &Cpu::Impl::Op_CBC7, 8 } },
-                { 0xCBC0, { "SET b,B",    &Cpu::Impl::Op_CBC0, 8 } },
-                { 0xCBC1, { "SET b,C",    &Cpu::Impl::Op_CBC1, 8 } },
-                { 0xCBC2, { "SET b,D",    &Cpu::Impl::Op_CBC2, 8 } },
-                { 0xCBC3, { "SET b,E",    &Cpu::Impl::Op_CBC3, 8 } },
-                { 0xCBC4, { "SET b,H",    &Cpu::Impl::Op_CBC4, 8 } },
-                { 0xCBC5, { "SET b,L",    &Cpu::Impl::Op_CBC5, 8 } },
-                { 0xCBC6, { "SET b,(HL)", &Cpu::Impl::Op_CBC6, 16 } },
-
-                { 0xCBC8, { "RES b,A",    &Cpu::Impl::Op_CB87, 8 } },
-                { 0xCB80, { "RES b,B",    &Cpu::Impl::Op_CB80, 8 } },
-                { 0xCB81, { "RES b,C",    &Cpu::Impl::Op_CB81, 8 } },
-                { 0xCB82, { "RES b,D",    &Cpu::Impl::Op_CB82, 8 } },
-                { 0xCB83, { "RES b,E",    &Cpu::Impl::Op_CB83, 8 } },
-                { 0xCB84, { "RES b,H",    &Cpu::Impl::Op_CB84, 8 } },
-                { 0xCB85, { "RES b,L",    &Cpu::Impl::Op_CB85, 8 } },
-                { 0xCB86, { "RES b,(HL)", &Cpu::Impl::Op_CB86, 16 } },
-
-                // Jumps
-                { 0x00C3, { "JP ##",    &Cpu::Impl::Op_00C3, 12 } },
-                { 0x00C2, { "JP NZ,##", &Cpu::Impl::Op_00C2, 12 } },
-                { 0x00CA, { "JP Z,##",  &Cpu::Impl::Op_00CA, 12 } },
-                { 0x00D2, { "JP NC,##", &Cpu::Impl::Op_00D2, 12 } },
-                { 0x00DA, { "JP C,##",  &Cpu::Impl::Op_00DA, 12 } },
-                { 0x00E9, { "JP (HL)",  &Cpu::Impl::Op_00E9, 4 } },
-                { 0x0018, { "JR #",     &Cpu::Impl::Op_0018, 8 } },
-                { 0x0020, { "JR NZ,#",  &Cpu::Impl::Op_0020, 8 } },
-                { 0x0028, { "JR Z,#",   &Cpu::Impl::Op_0028, 8 } },
-                { 0x0030, { "JR NC,#",  &Cpu::Impl::Op_0030, 8 } },
-                { 0x0038, { "JR C,#" ,  &Cpu::Impl::Op_0038, 8 } },
-
-                // Calls
-                { 0x00CD, { "CALL ##",    &Cpu::Impl::Op_00CD, 12 } },
-                { 0x00C4, { "CALL NZ,##", &Cpu::Impl::Op_00C4, 12 } },
-                { 0x00C4, { "CALL Z,##",  &Cpu::Impl::Op_00C4, 12 } },
-                { 0x00C4, { "CALL NC,##", &Cpu::Impl::Op_00C4, 12 } },
-                { 0x00C4, { "CALL C,##",  &Cpu::Impl::Op_00C4, 12 } },
-
-                // Restarts
-                { 0x00C7, { "RST 0x00", &Cpu::Impl::Op_00C7, 32 } },
-                { 0x00CF, { "RST 0x08", &Cpu::Impl::Op_00CF, 32 } },
-                { 0x00D7, { "RST 0x10", &Cpu::Impl::Op_00D7, 32 } },
-                { 0x00DF, { "RST 0x18", &Cpu::Impl::Op_00DF, 32 } },
-                { 0x00E7, { "RST 0x20", &Cpu::Impl::Op_00E7, 32 } },
-                { 0x00EF, { "RST 0x28", &Cpu::Impl::Op_00EF, 32 } },
-                { 0x00F7, { "RST 0x30", &Cpu::Impl::Op_00F7, 32 } },
-                { 0x00FF, { "RST 0x38", &Cpu::Impl::Op_00FF, 32 } },
-
-                // Returns
-                { 0x00C9, { "RET",    &Cpu::Impl::Op_00C9, 8 } },
-                { 0x00C0, { "RET NZ", &Cpu::Impl::Op_00C0, 8 } },
-                { 0x00C8, { "RET Z",  &Cpu::Impl::Op_00C8, 8 } },
-                { 0x00D0, { "RET NC", &Cpu::Impl::Op_00D0, 8 } },
-                { 0x00D8, { "RET C",  &Cpu::Impl::Op_00D8, 8 } },
-                { 0x00D9, { "RETI",   &Cpu::Impl::Op_00D9,8 } },
-        };
+//! \brief Opcode sequences the decoder fuses into a single dispatch.
+//!
+//! F(id, mnemonic, indices...). Ids count up from 0 and become dispatch
+//! indices 0x200 + id. The first matching row wins, so list longer sequences
+//! first. A sequence carries at most four immediate bytes in total, and only
+//! its last opcode may end a block. Add rows for whatever the opcode profile
+//! shows to be hot.
+#define GS_FUSIONS(F)                                                                   \
+        F(0, "LD A,(HL+); LD (DE),A; INC DE; DEC BC", 0x2A, 0x12, 0x13, 0x0B)           \
+        F(1, "LD A,B; OR C; JR NZ,#", 0x78, 0xB1, 0x20)                                 \
+        F(2, "LD (HL+),A; DEC B; JR NZ,#", 0x22, 0x05, 0x20)                            \
+        F(3, "LD (HL+),A; DEC BC", 0x22, 0x0B)                                          \
+        F(4, "LDH A,(#); AND #; JR Z,#", 0xF0, 0xE6, 0x28)                              \
+        F(5, "LDH A,(#); AND #; JR NZ,#", 0xF0, 0xE6, 0x20)                             \
+        F(6, "LDH A,(#); CP #; JR NZ,#", 0xF0, 0xFE, 0x20)                              \
+        F(7, "CP #; JR Z,#", 0xFE, 0x28)                                                \
+        F(8, "CP #; JR NZ,#", 0xFE, 0x20)                                               \
+        F(9, "CP #; JR C,#", 0xFE, 0x38)                                                \
+        F(10, "CP #; JR NC,#", 0xFE, 0x30)                                              \
+        F(11, "LD A,(HL+); LD (DE),A", 0x2A, 0x12)                                      \
+        F(12, "INC DE; DEC BC", 0x13, 0x0B)                                             \
+        F(13, "LD A,B; OR C", 0x78, 0xB1)
+
+//! \return number of immediate bytes following the opcode at index
+constexpr unsigned int Cpu::Impl::ImmBytes(unsigned int index) {
+        return (index < 0x100) ? InstructionLength(index) - 1 : 0;
+}
+
+template<unsigned int... Ops>
+constexpr Cpu::Impl::Fusion Cpu::Impl::MakeFusion(const char *name) {
+        constexpr unsigned int indices[] = { Ops... };
+        constexpr unsigned int count = sizeof...(Ops);
+        static_assert(count >= 2 && count <= 4, "fuse two to four opcodes");
+        static_assert((ImmBytes(Ops) + ...) <= 4, "at most four immediate bytes");
+        static_assert(((EndsBlock(Ops) ? 1u : 0u) + ...) == (EndsBlock(indices[count - 1]) ? 1u : 0u),
+                      "only the last opcode may end a block");
+        return { name, count, { static_cast<uint16_t>(Ops)... } };
+}
+
+#define GS_FUSION_ENTRY(id, name, ...) MakeFusion<__VA_ARGS__>(name),
+constexpr Cpu::Impl::Fusion Cpu::Impl::fusionTable[] = { GS_FUSIONS(GS_FUSION_ENTRY) };
+#undef GS_FUSION_ENTRY
+constexpr unsigned int Cpu::Impl::FusionCount = sizeof(fusionTable) / sizeof(fusionTable[0]);
+
+//! \brief Run one part of a superinstruction, taking its immediate bytes
+//! from the front of packed.
+template<typename Timing>
+template<unsigned int Index>
+void Cpu::Core<Timing>::stepFused(uint32_t &packed) {
+        constexpr unsigned int bits = 8 * ImmBytes(Index);
+        imm = packed & ((1u << bits) - 1);
+        packed >>= bits;
+        ((*this).*(instructionTable[Index].op))();
+}
+
+//! \brief Superinstruction handler: each part in turn, with the parts'
+//! immediates packed into imm. PC already points past the whole sequence,
+//! which only the last part, if it is a branch, looks at.
+template<typename Timing>
+template<unsigned int... Ops>
+void Cpu::Core<Timing>::Op_Fused() {
+        uint32_t packed = imm;
+        (stepFused<Ops>(packed), ...);
 }
 
 //------------------------------------------------------------------------------
 // Operations
 //------------------------------------------------------------------------------
 
-void Cpu::Impl::LD() {
-        operand1->set(operand2->get());
+template<typename Dst, typename Src>
+void Cpu::Impl::LD(Dst dst, Src src) {
+        dst.set(src.get());
+}
+
+//! \brief Put SP + n effective address into HL.
+//!
+//! n is signed. H and C are set from the unsigned addition of the low bytes.
+template<typename Src>
+void Cpu::Impl::LDHL(Src src) {
+        uint16_t value = cpu->SP;
+        uint8_t byte = src.get();
+        cpu->registers.r16.HL = value + static_cast<int8_t>(byte);
+
+        bool halfCarry = ((value & 0xF) + (byte & 0xF)) & 0x10;
+        bool carry = ((value & 0xFF) + byte) & 0x100;
+
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagH, halfCarry) | FlagIf(FlagC, carry));
 }
 
 //! Push register pair nn onto stack. Decrement Stack Pointer (SP) twice.
 //! Write Little-Endian, so the LSB occurs first in memory.
-void Cpu::Impl::PUSH() {
-        uint16_t word = operand1->get();
-        bus->write(--cpu->SP, static_cast<uint8_t>(word >> 8));
-        bus->write(--cpu->SP, static_cast<uint8_t>(word | 0xFF));
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::PUSH(Src src) {
+        uint16_t word = src.get();
+        tick(); // SP is decremented first
+        write(--cpu->SP, static_cast<uint8_t>(word >> 8));
+        write(--cpu->SP, static_cast<uint8_t>(word & 0xFF));
 }
 
 //! Pop two bytes off stack into register pair nn. Increment Stack Pointer (SP)
 //! twice.
-void Cpu::Impl::POP() {
-        uint16_t word = 0;
-        uint16_t byte = bus->read(cpu->SP++);
-        word = byte << 8;
-        byte = bus->read(cpu->SP++);
-        word |= byte;
-
-        operand1->set(word);
-}
-
-void Cpu::Impl::ADD8() {
-        uint8_t left = operand1->get();
-        uint8_t right = operand2->get();
-
-        uint8_t sum = left + right;
-        bool halfCarry = ((left & 0xF) + (right & 0xF)) & 0x10;
-        bool carry = ((uint16_t)left + (uint16_t)right) & 0x100;
+template<typename Timing>
+template<typename Dst>
+void Cpu::Core<Timing>::POP(Dst dst) {
+        uint16_t word = read(cpu->SP++);
+        word |= read(cpu->SP++) << 8;
+
+        dst.set(word);
+}
+
+template<typename Dst, typename Src>
+void Cpu::Impl::ADD8(Dst dst, Src src) {
+        uint8_t left = dst.get();
+        uint8_t right = src.get();
+#if defined(GSGB_ALU_TABLES)
+        AluResult r = alu::add[left << 8 | right];
+        dst.set(r.result);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, r.flags);
+#else
+        uint16_t sum = left + right;
 
-        operand1->set(sum);
+        dst.set(static_cast<uint8_t>(sum));
 
-        cpu->flagSet('z', 0 == sum);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry);
-        cpu->flagSet('c', carry);
+        deferFlags(LazyAdd, FlagZ | FlagH | FlagN | FlagC, left, right, sum);
+#endif
 }
 
-void Cpu::Impl::ADD16() {
-        uint16_t left = operand1->get();
-        uint16_t right = operand2->get();
-
-        uint16_t sum = left + right;
-        bool halfCarry = ((left & 0xFFF) + (right & 0xFFF)) & 0x1000;
-        bool carry = ((uint32_t)left + (uint32_t)right) & 0x10000;
+template<typename Src>
+void Cpu::Impl::ADD16(Src src) {
+        uint16_t left = cpu->registers.r16.HL;
+        uint16_t right = src.get();
+        uint32_t sum = left + right;
 
-        operand1->set(sum);
+        cpu->registers.r16.HL = static_cast<uint16_t>(sum);
 
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry);
-        cpu->flagSet('c', carry);
+        deferFlags(LazyAdd16, FlagH | FlagN | FlagC, left, right, sum);
 }
 
 //! The operand, along with the Carry Flag (C in the F Register) is added to the
 //! contents of the Accumulator, and the result is stored in the Accumulator.
-void Cpu::Impl::ADC8() {
-        uint8_t left = operand1->get();
-        uint8_t right = operand2->get();
-
-        uint8_t prevCarry = cpu->flagGet('c') ? 1 : 0;
-        uint8_t sum = left + right + prevCarry;
-        bool halfCarry = ((left & 0xF) + (right & 0xF) + prevCarry) & 0x10;
-        bool carry = ((uint16_t)left + (uint16_t)right + prevCarry) & 0x100;
+template<typename Dst, typename Src>
+void Cpu::Impl::ADC8(Dst dst, Src src) {
+        uint8_t left = dst.get();
+        uint8_t right = src.get();
+#if defined(GSGB_ALU_TABLES)
+        AluResult r = alu::add[carryFlag() << 16 | left << 8 | right];
+        dst.set(r.result);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, r.flags);
+#else
+        uint16_t sum = left + right + (carryFlag() ? 1 : 0);
 
-        operand1->set(sum);
+        dst.set(static_cast<uint8_t>(sum));
 
-        cpu->flagSet('z', 0 == sum);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry);
-        cpu->flagSet('c', carry);
+        deferFlags(LazyAdd, FlagZ | FlagH | FlagN | FlagC, left, right, sum);
+#endif
 }
 
-void Cpu::Impl::SUB8() {
-        int16_t minuend = cpu->registers.r8.A;
-        int16_t subtrahend = operand1->get();
+template<typename Src>
+void Cpu::Impl::SUB8(Src src) {
+        uint8_t minuend = cpu->registers.r8.A;
+        uint8_t subtrahend = src.get();
+#if defined(GSGB_ALU_TABLES)
+        AluResult r = alu::sub[minuend << 8 | subtrahend];
+        cpu->registers.r8.A = r.result;
+        setFlags(FlagZ | FlagH | FlagN | FlagC, r.flags);
+#else
+        uint32_t difference = minuend - subtrahend;
 
-        int16_t difference = minuend - subtrahend;
-        bool halfCarry = (minuend & 0xF) < (subtrahend & 0xF);
-        bool carry = minuend < subtrahend;
+        cpu->registers.r8.A = static_cast<uint8_t>(difference);
 
-        operand1->set(static_cast<uint8_t>(difference));
-
-        cpu->flagSet('z', 0 == difference);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry); // TODO: invert logic?
-        cpu->flagSet('c', carry); // TODO: invert logic?
+        deferFlags(LazySub, FlagZ | FlagH | FlagN | FlagC, minuend, subtrahend, difference);
+#endif
 }
 
-void Cpu::Impl::SBC8() {
-        int16_t minuend = cpu->registers.r8.A;
-        uint8_t prevCarry = cpu->flagGet('c') ? 1 : 0;
-        int16_t subtrahend = operand1->get() + prevCarry;
+template<typename Src>
+void Cpu::Impl::SBC8(Src src) {
+        uint8_t minuend = cpu->registers.r8.A;
+        uint8_t subtrahend = src.get();
+#if defined(GSGB_ALU_TABLES)
+        AluResult r = alu::sub[carryFlag() << 16 | minuend << 8 | subtrahend];
+        cpu->registers.r8.A = r.result;
+        setFlags(FlagZ | FlagH | FlagN | FlagC, r.flags);
+#else
+        uint32_t difference = minuend - subtrahend - (carryFlag() ? 1 : 0);
+
+        cpu->registers.r8.A = static_cast<uint8_t>(difference);
 
-        uint16_t difference = minuend - subtrahend;
-        bool halfCarry = (minuend & 0xF) < (subtrahend & 0xF);
-        bool carry = minuend < subtrahend;
+        deferFlags(LazySub, FlagZ | FlagH | FlagN | FlagC, minuend, subtrahend, difference);
+#endif
+}
 
-        operand1->set(static_cast<uint8_t>(difference));
+template<typename Src>
+void Cpu::Impl::AND(Src src) {
+        cpu->registers.r8.A &= src.get();
 
-        cpu->flagSet('z', 0 == difference);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry); // TODO: invert logic?
-        cpu->flagSet('c', carry); // TODO: invert logic?
+        deferFlags(LazyLogic, FlagZ | FlagH | FlagN | FlagC, 0, 0, cpu->registers.r8.A);
 }
 
-void Cpu::Impl::AND() {
-        cpu->registers.r8.A &= operand1->get();
+template<typename Src>
+void Cpu::Impl::OR(Src src) {
+        cpu->registers.r8.A |= src.get();
 
-        cpu->flagSet('z', 0 == cpu->registers.r8.A);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', 0);
+        deferFlags(LazyLogic, FlagZ | FlagH | FlagN | FlagC, 0, 0, cpu->registers.r8.A);
 }
 
-void Cpu::Impl::OR() {
-        cpu->registers.r8.A |= operand1->get();
+template<typename Src>
+void Cpu::Impl::XOR(Src src) {
+        cpu->registers.r8.A ^= src.get();
 
-        cpu->flagSet('z', 0 == cpu->registers.r8.A);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', 0);
+        deferFlags(LazyLogic, FlagZ | FlagH | FlagN | FlagC, 0, 0, cpu->registers.r8.A);
 }
 
-void Cpu::Impl::XOR() {
-        cpu->registers.r8.A ^= operand1->get();
+template<typename Src>
+void Cpu::Impl::CP(Src src) {
+        uint8_t minuend = cpu->registers.r8.A;
+        uint8_t subtrahend = src.get();
 
-        cpu->flagSet('z', 0 == cpu->registers.r8.A);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', 0);
+#if defined(GSGB_ALU_TABLES)
+        setFlags(FlagZ | FlagH | FlagN | FlagC, alu::sub[minuend << 8 | subtrahend].flags);
+#else
+        deferFlags(LazySub, FlagZ | FlagH | FlagN | FlagC, minuend, subtrahend, minuend - subtrahend);
+#endif
 }
 
-void Cpu::Impl::CP() {
-        int16_t minuend = cpu->registers.r8.A;
-        int16_t subtrahend = operand1->get();
-        int16_t result = minuend - subtrahend;
-        bool halfCarry = (minuend & 0xF) < (subtrahend & 0xF);
+//! INC and DEC leave C alone.
+template<typename Dst>
+void Cpu::Impl::INC8(Dst dst) {
+        uint8_t val = dst.get();
+#if defined(GSGB_ALU_TABLES)
+        AluResult r = alu::inc[val];
+        dst.set(r.result);
+        setFlags(FlagZ | FlagH | FlagN, r.flags);
+#else
+        uint8_t result = val + 1;
+        dst.set(result);
 
-        cpu->flagSet('z', 0 == result);
-        cpu->flagSet('n', 1);
-        cpu->flagSet('h', halfCarry);
-        cpu->flagSet('c', minuend < subtrahend);
+        deferFlags(LazyAdd, FlagZ | FlagH | FlagN, val, 1, result);
+#endif
 }
 
-void Cpu::Impl::INC8() {
-        auto val = operand1->get();
-        bool halfCarry = ((val & 0xF) + 1) & 0x10;
-        operand1->set(++val);
+template<typename Dst>
+void Cpu::Impl::DEC8(Dst dst) {
+        uint8_t val = dst.get();
+#if defined(GSGB_ALU_TABLES)
+        AluResult r = alu::dec[val];
+        dst.set(r.result);
+        setFlags(FlagZ | FlagH | FlagN, r.flags);
+#else
+        uint8_t result = val - 1;
+        dst.set(result);
 
-        cpu->flagSet('z', 0 == val);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry);
+        deferFlags(LazySub, FlagZ | FlagH | FlagN, val, 1, result);
+#endif
 }
 
-void Cpu::Impl::DEC8() {
-        auto val = operand1->get();
-        bool halfCarry = (val & 0xF) < 1;
-        operand1->set(--val);
+//! \brief Add signed n to Stack Pointer (SP).
+//!
+//! H and C are set from the unsigned addition of the low bytes.
+template<typename Src>
+void Cpu::Impl::ADDSP(Src src) {
+        uint16_t value = cpu->SP;
+        uint8_t byte = src.get();
+        cpu->SP = value + static_cast<int8_t>(byte);
+
+        bool halfCarry = ((value & 0xF) + (byte & 0xF)) & 0x10;
+        bool carry = ((value & 0xFF) + byte) & 0x100;
+
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagH, halfCarry) | FlagIf(FlagC, carry));
+}
 
-        cpu->flagSet('z', 0 == val);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', halfCarry);
+template<typename Dst>
+void Cpu::Impl::INC16(Dst dst) {
+        dst.set(dst.get() + 1);
 }
 
-void Cpu::Impl::INC16() {
-        auto value = operand1->get();
-        operand1->set(value++);
+template<typename Dst>
+void Cpu::Impl::DEC16(Dst dst) {
+        dst.set(dst.get() - 1);
 }
 
-void Cpu::Impl::DEC16() {
-        auto value = operand1->get();
-        operand1->set(value--);
+#if defined(GSGB_ALU_TABLES)
+//! \brief Shift or rotate through alu::shift, writing only the flags in mask.
+template<typename Dst>
+void Cpu::Impl::ShiftByTable(int kind, uint8_t mask, Dst dst) {
+        AluResult r = alu::shift[kind][carryFlag() << 8 | dst.get()];
+        dst.set(r.result);
+        setFlags(mask, r.flags & mask);
 }
+#endif
 
 //! \brief Swap upper & lower nibbles of operand.
-void Cpu::Impl::SWAP() {
-        uint8_t oldValue = operand1->get();
+template<typename Dst>
+void Cpu::Impl::SWAP(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::SWAP, FlagZ | FlagH | FlagN | FlagC, dst);
+#else
+        uint8_t oldValue = dst.get();
         uint8_t nibbleHi = Nibble(oldValue, 1);
         uint8_t nibbleLo = Nibble(oldValue, 0);
         uint8_t newValue = (nibbleLo << 4) | nibbleHi;
-        operand2->set(newValue);
+        dst.set(newValue);
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', 0);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagZ, !newValue));
+#endif
 }
 
 //! \brief Decimal adjust register A.
@@ -3980,11 +1351,22 @@ void Cpu::Impl::SWAP() {
 //!
 //! \see https://ehaskins.com/2018-01-30%20Z80%20DAA/
 void Cpu::Impl::DAA() {
+#if defined(GSGB_ALU_TABLES)
+        uint8_t f = flags();
+        unsigned int index = cpu->registers.r8.A;
+        index |= (f & FlagH) ? 0x100 : 0;
+        index |= (f & FlagC) ? 0x200 : 0;
+        index |= (f & FlagN) ? 0x400 : 0;
+        AluResult r = alu::daa[index];
+        cpu->registers.r8.A = r.result;
+        setFlags(FlagZ | FlagH | FlagP | FlagC, r.flags);
+#else
         uint8_t val = cpu->registers.r8.A;
 
-        uint8_t wasCarryHalf = cpu->flagGet('h');
-        uint8_t wasCarry = cpu->flagGet('c');
-        uint8_t wasSubtraction = cpu->flagGet('n');
+        uint8_t f = flags();
+        bool wasCarryHalf = f & FlagH;
+        bool wasCarry = f & FlagC;
+        bool wasSubtraction = f & FlagN;
 
         uint8_t nibbleLo = Nibble(val, 0);
         uint8_t nibbleHi = Nibble(val, 1);
@@ -4008,19 +1390,16 @@ void Cpu::Impl::DAA() {
         uint8_t newValue = (nibbleHi << 4) | nibbleLo;
         cpu->registers.r8.A = newValue;
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('p', Parity(newValue));
-        cpu->flagSet('c', newValue > 0x99); // TODO verify against table in Z80 manual
+        // TODO: verify C against table in Z80 manual
+        setFlags(FlagZ | FlagH | FlagP | FlagC, FlagIf(FlagZ, !newValue) | FlagIf(FlagP, Parity(newValue)) | FlagIf(FlagC, newValue > 0x99));
+#endif
 }
 
 //! \brief The contents of the Accumulator (Register A) are inverted (one’s complement).
 void Cpu::Impl::CPL() {
-        uint8_t val = ~(cpu->registers.r8.A);
-        operand2->set(val);
+        cpu->registers.r8.A = ~(cpu->registers.r8.A);
 
-        cpu->flagSet('h', 1);
-        cpu->flagSet('n', 1);
+        setFlags(FlagH | FlagN, FlagH | FlagN);
 }
 
 // // TODO: Not used in GB?
@@ -4033,7 +1412,7 @@ void Cpu::Impl::CPL() {
 // //         uint16_t val = static_cast<uint8_t>(operand2->get());
 // //         uint16_t onesComplement = ~val;
 // //         uint16_t twosComplement = onesComplement + 1;
-// //        operand2->set(static_cast<uint8_t>(twosComplement));
+// //        dst.set(static_cast<uint8_t>(twosComplement));
 
 // //         flagSet('s', twosComplement & 0x7);
 // //         flagSet('z', !twosComplement);
@@ -4045,16 +1424,12 @@ void Cpu::Impl::CPL() {
 
 //! \brief The carry flag is inverted in the F register.
 void Cpu::Impl::CCF() {
-        cpu->flagSet('h', 0);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('c', !cpu->flagGet('c'));
+        setFlags(FlagH | FlagN | FlagC, FlagIf(FlagC, !carryFlag()));
 }
 
 //! \brief the carry flag is set in the F register.
 void Cpu::Impl::SCF() {
-        cpu->flagSet('h', 0);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('c', 1);
+        setFlags(FlagH | FlagN | FlagC, FlagC);
 }
 
 void Cpu::Impl::NOP() {
@@ -4071,23 +1446,53 @@ void Cpu::Impl::HALT() {
 }
 
 //! \brief Halt CPU & LCD display until button press.
+//! \brief Skip time while halted.
+//!
+//! Rather than idling an instruction at a time, jump from one peripheral event
+//! to the next, letting the Bus raise interrupts in bulk, until an enabled
+//! interrupt is requested. The CPU then resumes after the HALT. STOP only ends
+//! on a button press, and the joypad isn't wired to the bus, so it never wakes.
+//!
+//! \return clock at which the CPU woke up, or target if it is still halted
+uint64_t Cpu::Impl::haltUntil(uint64_t now, uint64_t target) {
+        if (waitForButtonPress) {
+                return (now < target) ? target : now;
+        }
+
+        bus->advance(now);
+        while (!bus->pendingInterrupts()) {
+                uint64_t event = bus->nextEvent(now);
+                if (event >= target) {
+                        return (now < target) ? target : now;
+                }
+                now = event;
+                bus->advance(now);
+        }
+
+        halted = false;
+        return now;
+}
+
 void Cpu::Impl::STOP() {
         halted = true;
         waitForButtonPress = true;
 }
 
-//! \brief Disable interrupts after next Instruction.
+//! \brief Disable interrupts.
 //!
 //! When the CPU executes the Instruction DI the maskable interrupt is disabled
 //! until it is subsequently re-enabled by an EI Instruction. The CPU does not
-//! respond to an Interrupt Request (INT) signal.
+//! respond to an Interrupt Request (INT) signal. Unlike EI this takes effect
+//! immediately, and cancels an EI still waiting to.
 void Cpu::Impl::DI() {
-        interruptsDisabledRequested = true;
+        ime = false;
+        imeDelayed = false;
 }
 
 //! \brief Enable interrupts after next Instruction.
 void Cpu::Impl::EI() {
-        interruptsEnabledRequested = true;
+        imeDelayed = true;
+        cpu->raiseAttention();
 }
 
 //! \brief Rotate A left. Old bit 7 is copied to the carry flag.
@@ -4096,15 +1501,16 @@ void Cpu::Impl::EI() {
 //! position. The sign bit (bit 7) is copied to the Carry flag and also to bit
 //! 0. Bit 0 is the least-significant bit.
 void Cpu::Impl::RLCA() {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RLC, FlagZ | FlagH | FlagN | FlagC, Reg8<&R8::A>::resolve(*this));
+#else
         uint8_t oldValue = cpu->registers.r8.A;
         uint8_t carry = ((uint8_t)oldValue >> 0x7) & 0x1;
         uint8_t newValue = ((uint8_t)oldValue << 1) | carry;
         cpu->registers.r8.A = newValue;
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagZ, !newValue) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Rotate A left through the carry flag.
@@ -4113,16 +1519,17 @@ void Cpu::Impl::RLCA() {
 //! through the Carry flag. The previous contents of the Carry flag are copied
 //! to bit 0. Bit 0 is the least-significant bit.
 void Cpu::Impl::RLA() {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RL, FlagZ | FlagH | FlagN | FlagC, Reg8<&R8::A>::resolve(*this));
+#else
         uint16_t oldValue = cpu->registers.r8.A;
         uint8_t carry = ((uint8_t)oldValue >> 0x7) & 0x1;
-        uint8_t oldCarry = cpu->flagGet('c');
+        uint8_t oldCarry = carryFlag();
         uint8_t newValue = ((uint8_t)oldValue << 1) | oldCarry;
         cpu->registers.r8.A = newValue;
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagZ, !newValue) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Rotate A right. Old bit 0 is copied to the carry flag.
@@ -4131,15 +1538,16 @@ void Cpu::Impl::RLA() {
 //! position. Bit 0 is cop-ied to the Carry flag and also to bit 7. Bit 0 is the
 //! least-significant bit.
 void Cpu::Impl::RRCA() {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RRC, FlagZ | FlagH | FlagN | FlagC, Reg8<&R8::A>::resolve(*this));
+#else
         uint16_t oldValue = cpu->registers.r8.A;
         uint8_t carry = (uint8_t)oldValue & 0x1;
         uint8_t newValue = ((uint8_t)oldValue >> 1) | (carry << 0x7);
         cpu->registers.r8.A = newValue;
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagZ, !newValue) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Rotate A right through the carry flag.
@@ -4148,16 +1556,17 @@ void Cpu::Impl::RRCA() {
 //! position through the Carry flag. The previous contents of the Carry flag are
 //! copied to bit 7. Bit 0 is the least-significant bit.
 void Cpu::Impl::RRA() {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RR, FlagZ | FlagH | FlagN | FlagC, Reg8<&R8::A>::resolve(*this));
+#else
         uint16_t oldValue = cpu->registers.r8.A;
         uint8_t carry = (uint8_t)oldValue & 0x1;
-        uint8_t oldCarry = cpu->flagGet('c');
+        uint8_t oldCarry = carryFlag();
         uint8_t newValue = ((uint8_t)oldValue >> 1) | (oldCarry << 0x7);
         cpu->registers.r8.A = newValue;
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagZ, !newValue) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Rotate left. Old bit 7 is copied to the carry flag.
@@ -4172,18 +1581,18 @@ void Cpu::Impl::RRA() {
 //! H: 100
 //! L: 101
 //! A: 111
-void Cpu::Impl::RLC() {
-        uint16_t oldValue = operand1->get();
+template<typename Dst>
+void Cpu::Impl::RLC(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RLC, FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, dst);
+#else
+        uint16_t oldValue = dst.get();
         uint8_t carry = ((uint8_t)oldValue >> 0x7) & 0x1;
         uint8_t newValue = ((uint8_t)oldValue << 1) | carry;
-        operand1->set(newValue);
+        dst.set(newValue);
 
-        cpu->flagSet('s', newValue & (0x1 << 0x7));
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('p', Parity(newValue));
-        cpu->flagSet('n', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, FlagIf(FlagS, newValue & (0x1 << 0x7)) | FlagIf(FlagZ, !newValue) | FlagIf(FlagP, Parity(newValue)) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Rotate left through carry flag.
@@ -4191,19 +1600,19 @@ void Cpu::Impl::RLC() {
 //! The contents of the m operand are rotated left 1 bit position. The contents
 //! of bit 7 are copied to the Carry flag, and the previous contents of the
 //! Carry flag are copied to bit 0.
-void Cpu::Impl::RL() {
-        uint16_t oldValue = operand1->get();
+template<typename Dst>
+void Cpu::Impl::RL(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RL, FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, dst);
+#else
+        uint16_t oldValue = dst.get();
         uint8_t carry = ((uint8_t)oldValue >> 0x7) & 0x1;
-        uint8_t oldCarry = cpu->flagGet('c');
+        uint8_t oldCarry = carryFlag();
         uint8_t newValue = ((uint8_t)oldValue << 1) | oldCarry;
-        operand1->set(newValue);
+        dst.set(newValue);
 
-        cpu->flagSet('s', newValue & (0x1 << 0x7));
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('p', Parity(newValue));
-        cpu->flagSet('n', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, FlagIf(FlagS, newValue & (0x1 << 0x7)) | FlagIf(FlagZ, !newValue) | FlagIf(FlagP, Parity(newValue)) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Rotate right. Old bit 0 is set to the carry flag.
@@ -4211,18 +1620,18 @@ void Cpu::Impl::RL() {
 //! The contents of the m operand are rotated right 1 bit position. The contents
 //! of bit 0 are copied to the Carry flag and also to bit 7. Bit 0 is the
 //! least-significant bit.
-void Cpu::Impl::RRC() {
-        uint16_t oldValue = operand1->get();
+template<typename Dst>
+void Cpu::Impl::RRC(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RRC, FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, dst);
+#else
+        uint16_t oldValue = dst.get();
         uint8_t carry = (uint8_t)oldValue & 0x1;
-        uint8_t newValue = ((uint8_t)oldValue >> 1) | carry;
-        operand1->set(newValue);
+        uint8_t newValue = ((uint8_t)oldValue >> 1) | (carry << 0x7);
+        dst.set(newValue);
 
-        cpu->flagSet('s', newValue & (0x1 << 0x7));
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('p', Parity(newValue));
-        cpu->flagSet('n', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, FlagIf(FlagS, newValue & (0x1 << 0x7)) | FlagIf(FlagZ, !newValue) | FlagIf(FlagP, Parity(newValue)) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Rotate n right through carry flag.
@@ -4231,19 +1640,19 @@ void Cpu::Impl::RRC() {
 //! flag. The contents of bit 0 are copied to the carry flag and the previous
 //! contents of the carry flag are copied to bit 7. Bit 0 is the
 //! least-significant bit.
-void Cpu::Impl::RR() {
-        uint16_t oldValue = operand1->get();
+template<typename Dst>
+void Cpu::Impl::RR(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::RR, FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, dst);
+#else
+        uint16_t oldValue = dst.get();
         uint8_t carry = (uint8_t)oldValue & 0x1;
-        uint8_t oldCarry = cpu->flagGet('c');
-        uint8_t newValue = ((uint8_t)oldValue >> 1) | oldCarry;
-        operand1->set(newValue);
+        uint8_t oldCarry = carryFlag();
+        uint8_t newValue = ((uint8_t)oldValue >> 1) | (oldCarry << 0x7);
+        dst.set(newValue);
 
-        cpu->flagSet('s', newValue & (0x1 << 0x7));
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('p', Parity(newValue));
-        cpu->flagSet('n', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, FlagIf(FlagS, newValue & (0x1 << 0x7)) | FlagIf(FlagZ, !newValue) | FlagIf(FlagP, Parity(newValue)) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Shift left into carry. LSB is set to 0.
@@ -4251,18 +1660,18 @@ void Cpu::Impl::RR() {
 //! An arithmetic shift left 1 bit position is performed on the contents of
 //! operand m. The contents of bit 7 are copied to the Carry flag. Bit 0 is the
 //! least-significant bit.
-void Cpu::Impl::SLA() {
-        uint8_t oldValue = operand1->get();
-        uint8_t carry = oldValue & (0x1 << 0x7);
+template<typename Dst>
+void Cpu::Impl::SLA(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::SLA, FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, dst);
+#else
+        uint8_t oldValue = dst.get();
+        uint8_t carry = (oldValue >> 0x7) & 0x1;
         uint8_t newValue = oldValue << 1;
-        operand1->set(newValue);
+        dst.set(newValue);
 
-        cpu->flagSet('s', (newValue >> 0x7) & 0x1);
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('p', Parity(newValue));
-        cpu->flagSet('n', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagS | FlagZ | FlagH | FlagP | FlagN | FlagC, FlagIf(FlagS, (newValue >> 0x7) & 0x1) | FlagIf(FlagZ, !newValue) | FlagIf(FlagP, Parity(newValue)) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Shift right into Carry. MSB doesn't change.
@@ -4271,17 +1680,19 @@ void Cpu::Impl::SLA() {
 //! operand m. The contents of bit 0 are copied to the Carry flag and the
 //! previous contents of bit 7 remain unchanged. Bit 0 is the least-significant
 //! bit.
-void Cpu::Impl::SRA() {
-        uint8_t oldValue = operand1->get();
-        uint8_t msb = (oldValue & 0x7);
+template<typename Dst>
+void Cpu::Impl::SRA(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::SRA, FlagZ | FlagH | FlagN | FlagC, dst);
+#else
+        uint8_t oldValue = dst.get();
+        uint8_t msb = (oldValue & 0x80);
         uint8_t carry = oldValue & 0x1;
         uint8_t newValue = (oldValue >> 1) | msb;
-        operand1->set(newValue);
+        dst.set(newValue);
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagZ, !newValue) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Shift right into Carry. MSB is set to 0.
@@ -4289,81 +1700,105 @@ void Cpu::Impl::SRA() {
 //! The contents of operand m are shifted right 1 bit position. The contents of
 //! bit 0 are copied to the Carry flag, and bit 7 is reset. Bit 0 is the
 //! least-significant bit.
-void Cpu::Impl::SRL() {
-        uint8_t oldValue = operand1->get();
+template<typename Dst>
+void Cpu::Impl::SRL(Dst dst) {
+#if defined(GSGB_ALU_TABLES)
+        ShiftByTable(alu::SRL, FlagZ | FlagH | FlagN | FlagC, dst);
+#else
+        uint8_t oldValue = dst.get();
         uint8_t carry = oldValue & 0x1;
         uint8_t newValue = oldValue >> 1;
-        operand1->set(newValue);
+        dst.set(newValue);
 
-        cpu->flagSet('z', !newValue);
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 0);
-        cpu->flagSet('c', carry);
+        setFlags(FlagZ | FlagH | FlagN | FlagC, FlagIf(FlagZ, !newValue) | FlagIf(FlagC, carry));
+#endif
 }
 
 //! \brief Test bit in register
 //!
 //! This Instruction tests bit b in register r and sets the Z flag
 //! accordingly.
-void Cpu::Impl::BIT() {
-        uint8_t bit = operand1->get();
-        uint8_t byte = operand2->get();
+template<typename Pos, typename Src>
+void Cpu::Impl::BIT(Pos pos, Src src) {
+        uint8_t bit = pos.get();
+        uint8_t byte = src.get();
         uint8_t test = 0x1 << bit;
 
-        cpu->flagSet('z', !(byte & test));
-        cpu->flagSet('n', 0);
-        cpu->flagSet('h', 1);
+        setFlags(FlagZ | FlagH | FlagN, FlagIf(FlagZ, !(byte & test)) | FlagH);
 }
 
 //! \brief Set bit in register
 //!
 //! Bit b in register r (any of registers B, C, D, E, H, L, or A) is set.
-void Cpu::Impl::SET() {
-        uint8_t bit = operand1->get();
-        uint8_t byte = operand2->get();
+template<typename Pos, typename Dst>
+void Cpu::Impl::SET(Pos pos, Dst dst) {
+        uint8_t bit = pos.get();
+        uint8_t byte = dst.get();
         uint8_t set = 0x1 << bit;
-        operand2->set(byte | set);
+        dst.set(byte | set);
 }
 
 //! Reset bit in register.
-void Cpu::Impl::RES() {
-        uint8_t bit = operand1->get();
-        uint8_t byte = operand2->get();
+template<typename Pos, typename Dst>
+void Cpu::Impl::RES(Pos pos, Dst dst) {
+        uint8_t bit = pos.get();
+        uint8_t byte = dst.get();
         uint8_t set = 0x1 << bit;
         set = ~set;
-        operand2->set(byte & set);
+        dst.set(byte & set);
 }
 
-void Cpu::Impl::JP() {
-        cpu->PC = operand1->get();
+template<typename Src>
+void Cpu::Impl::JP(Src src) {
+        cpu->PC = src.get();
 }
 
 //! \brief Add n to current address and jump to it
-void Cpu::Impl::JR() {
-        uint16_t address = cpu->PC + operand1->get();
+template<typename Src>
+void Cpu::Impl::JR(Src src) {
+        uint16_t address = cpu->PC + static_cast<int8_t>(src.get());
         cpu->PC = address;
 }
 
 //! \brief Push address of next Instruction onto the stack and then jump to address nn
-void Cpu::Impl::CALL() {
-        bus->write(--cpu->SP, static_cast<uint8_t>(cpu->PC & 0xFF));
-        bus->write(--cpu->SP, static_cast<uint8_t>(cpu->PC >> 8));
-        cpu->PC = operand1->get();
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::CALL(Src src) {
+        tick(); // SP is decremented first
+        write(--cpu->SP, static_cast<uint8_t>(cpu->PC >> 8));
+        write(--cpu->SP, static_cast<uint8_t>(cpu->PC & 0xFF));
+        cpu->PC = src.get();
+#if defined(GSGB_PROFILE)
+        if (cpu->stacks != nullptr) {
+                cpu->stacks->call(cpu->PC, codeBank(cpu->PC), cpu->SP);
+        }
+#endif
 }
 
 //! Push present address onto stack. Jump to address $0000 + n.
-void Cpu::Impl::RST() {
-        bus->write(--cpu->SP, static_cast<uint8_t>(cpu->PC & 0xFF));
-        bus->write(--cpu->SP, static_cast<uint8_t>(cpu->PC >> 8));
-        cpu->PC = operand1->get();
-}
-
-void Cpu::Impl::RET() {
-        uint16_t address;
-        uint8_t byte = bus->read(cpu->SP++);
-        address = byte << 8;
-        byte = bus->read(cpu->SP++);
-        address = address | byte;
+template<typename Timing>
+template<typename Src>
+void Cpu::Core<Timing>::RST(Src src) {
+        tick(); // SP is decremented first
+        write(--cpu->SP, static_cast<uint8_t>(cpu->PC >> 8));
+        write(--cpu->SP, static_cast<uint8_t>(cpu->PC & 0xFF));
+        cpu->PC = src.get();
+#if defined(GSGB_PROFILE)
+        if (cpu->stacks != nullptr) {
+                cpu->stacks->call(cpu->PC, 0, cpu->SP);
+        }
+#endif
+}
+
+template<typename Timing>
+void Cpu::Core<Timing>::RET() {
+#if defined(GSGB_PROFILE)
+        if (cpu->stacks != nullptr) {
+                cpu->stacks->ret(cpu->SP);
+        }
+#endif
+        uint16_t address = read(cpu->SP++);
+        address |= read(cpu->SP++) << 8;
         cpu->PC = address;
 }
 
@@ -4381,61 +1816,762 @@ void Cpu::Impl::RET() {
 //!   doing the RETI Instruction, the enable interrupt Instruction (EI) should be
 //!   executed to allow recognition of interrupts after completion of the current
 //!   service routine.
-void Cpu::Impl::RETI() {
+template<typename Timing>
+void Cpu::Core<Timing>::RETI() {
         RET();
-        interruptsDisabled = false;
-        interruptsDisabledRequested = false;
-        interruptsEnabledRequested = false;
+        ime = true;
+        imeDelayed = false;
+        cpu->raiseAttention();
+}
+
+//! \brief Dispatch the highest priority interrupt, if IME allows it.
+//!
+//! Only called once the clock reaches Cpu::attentionAt, so the instruction
+//! loop never tests IF and IE itself. Afterwards attentionAt is set to the
+//! next peripheral event if IME is set, or left alone until something raises
+//! attention again.
+//!
+//! EI ends a block, so the first call after it comes before the following
+//! instruction has run. If an interrupt is already pending that instruction is
+//! run here, on its own, before dispatching.
+//!
+//! \return clock after dispatching, which takes 20 cycles
+template<typename Timing>
+uint64_t Cpu::Core<Timing>::serviceInterrupts(uint64_t now) {
+        bus->advance(now);
+
+        if (imeDelayed) {
+                imeDelayed = false;
+                ime = true;
+                if (bus->pendingInterrupts() != 0) {
+                        now += step(now);
+                }
+        }
+
+        uint8_t pending = bus->pendingInterrupts();
+        if (ime && pending != 0) {
+                unsigned int bit = 0;
+                while (!(pending & (1 << bit))) {
+                        bit++;
+                }
+                bus->memRegisters.intFlag &= ~(1 << bit);
+                ime = false;
+                halted = false;
+
+                if (PerAccess) {
+                        cpu->cycles = now + 8; // two internal M-cycles come first
+                }
+                write(--cpu->SP, static_cast<uint8_t>(cpu->PC >> 8));
+                write(--cpu->SP, static_cast<uint8_t>(cpu->PC & 0xFF));
+                cpu->PC = static_cast<uint16_t>(0x40 + 8 * bit);
+#if defined(GSGB_PROFILE)
+                if (cpu->stacks != nullptr) {
+                        cpu->stacks->call(cpu->PC, 0, cpu->SP);
+                }
+#endif
+                now += 20;
+        }
+
+        cpu->attentionAt = ime ? bus->nextEvent(now) : UINT64_MAX;
+        return now;
+}
+
+//------------------------------------------------------------------------------
+// Decoding
+//------------------------------------------------------------------------------
+
+//! \brief Decode the instruction at addr without executing it.
+//! \return the dispatch table entry for it
+template<typename Timing>
+const typename Cpu::Core<Timing>::Instruction &Cpu::Core<Timing>::decode(uint16_t addr, DecodedOp &op) {
+        unsigned int index = bus->read(addr);
+        if (0xCB == index) {
+                index = 0x100 | bus->read(addr + 1);
+        }
+
+        const Instruction &instruction = instructionTable[index];
+        op.index = static_cast<uint16_t>(index);
+        op.length = static_cast<uint8_t>(instruction.length);
+        op.cycles = static_cast<uint8_t>(instruction.cycles);
+        op.imm = 0;
+        if (index < 0x100 && instruction.length >= 2) {
+                op.imm = bus->read(addr + 1);
+                if (instruction.length == 3) {
+                        op.imm |= static_cast<uint16_t>(bus->read(addr + 2)) << 8;
+                }
+        }
+
+        return instruction;
+}
+
+//! \brief Decode and cache the basic block starting at pc.
+//!
+//! Decoding stops after the first instruction that may transfer control, after
+//! BlockCache::MaxOps instructions, or when the next instruction lies in a
+//! different 16KB region, since those may be mapped independently. With
+//! MCycleTiming every block is a single instruction, so peripherals and
+//! interrupts are looked at between each.
+template<typename Timing>
+Block *Cpu::Core<Timing>::buildBlock(uint16_t pc, uint16_t bank) {
+        std::unique_ptr<Block> block(new Block());
+        block->key = BlockCache::key(pc, bank);
+        block->start = pc;
+        block->cycles = 0;
+
+        uint16_t addr = pc;
+        for (;;) {
+                DecodedOp op;
+                const Instruction &instruction = decode(addr, op);
+                block->ops.push_back(op);
+                block->cycles += op.cycles;
+                addr += op.length;
+
+                if (instruction.endsBlock || PerAccess || block->ops.size() >= BlockCache::MaxOps ||
+                    ((addr ^ pc) & 0xC000) != 0) {
+                        break;
+                }
+        }
+        block->end = addr;
+        block->poll = findPoll(*block);
+        if (pc < 0x8000 && !PerAccess) {
+                block->native = cpu->aot->find((pc & 0xC000) == 0x4000 ? bank : 0, *block);
+        }
+
+        // Code in RAM may be rewritten under a superinstruction, and traces
+        // record opcodes one at a time. Single instruction blocks have
+        // nothing to fuse.
+        if (!Trace::Enabled && !PerAccess && pc < 0x8000) {
+                fuse(*block);
+        }
+
+        return cpu->cache->insert(std::move(block));
+}
+
+//! \brief Replace runs of ops listed in GS_FUSIONS with superinstructions.
+void Cpu::Impl::fuse(Block &block) {
+        std::vector<DecodedOp> &ops = block.ops;
+        std::size_t out = 0;
+
+        for (std::size_t i = 0; i < ops.size();) {
+                unsigned int id = 0;
+                for (; id < FusionCount; id++) {
+                        const Fusion &f = fusionTable[id];
+                        unsigned int j = 0;
+                        while (j < f.count && i + j < ops.size() && ops[i + j].index == f.ops[j]) {
+                                j++;
+                        }
+                        if (j == f.count) {
+                                break;
+                        }
+                }
+
+                if (id == FusionCount) {
+                        ops[out++] = ops[i++];
+                        continue;
+                }
+
+                DecodedOp fused = { static_cast<uint16_t>(0x200 + id), 0, 0, 0 };
+                unsigned int shift = 0;
+                for (unsigned int j = 0; j < fusionTable[id].count; j++, i++) {
+                        fused.imm |= ops[i].imm << shift;
+                        fused.length += ops[i].length;
+                        fused.cycles += ops[i].cycles;
+                        shift += 8 * ImmBytes(ops[i].index);
+                }
+                ops[out++] = fused;
+        }
+
+        ops.resize(out);
+}
+
+//! \brief Split a superinstruction back into its parts.
+//! \param out room for four ops
+//! \return number of ops written to out; 1 if op isn't fused
+unsigned int Cpu::Impl::Unfuse(const DecodedOp &op, DecodedOp *out) {
+        if (op.index < 0x200) {
+                out[0] = op;
+                return 1;
+        }
+
+        const Fusion &f = fusionTable[op.index - 0x200];
+        uint32_t packed = op.imm;
+        for (unsigned int j = 0; j < f.count; j++) {
+                const auto &instruction = Core<FastTiming>::instructionTable[f.ops[j]];
+                unsigned int bits = 8 * ImmBytes(f.ops[j]);
+                out[j].index = f.ops[j];
+                out[j].imm = packed & ((1u << bits) - 1);
+                out[j].length = static_cast<uint8_t>(instruction.length);
+                out[j].cycles = static_cast<uint8_t>(instruction.cycles);
+                packed >>= bits;
+        }
+        return f.count;
+}
+
+//! \brief Recognize a block that polls an I/O register in a tight loop.
+//!
+//! The block must load A from 0xFF00-0xFFFF, test it using only ops that write
+//! A and F, and branch back to its own start. Every iteration then does the
+//! same thing until the register changes, so skipIdle() can pass the time in
+//! one step. For example:
+//!
+//!     loop: LDH A,(0x44)
+//!           CP 0x90
+//!           JR NZ,loop
+//!
+//! \return address of the polled register, or 0
+uint16_t Cpu::Impl::findPoll(const Block &block) {
+        const std::vector<DecodedOp> &ops = block.ops;
+        if (ops.size() < 2) {
+                return 0;
+        }
+
+        uint16_t addr;
+        switch (ops.front().index) {
+                case 0xF0: // LDH A,(n)
+                        addr = 0xFF00 | ops.front().imm;
+                        break;
+                case 0xFA: // LD A,(nn)
+                        addr = ops.front().imm;
+                        break;
+                default:
+                        return 0;
+        }
+        if (addr < 0xFF00) {
+                return 0;
+        }
+
+        const DecodedOp &branch = ops.back();
+        uint16_t target;
+        switch (branch.index) {
+                case 0x20: case 0x28: case 0x30: case 0x38: // JR cc
+                        target = block.end + static_cast<int8_t>(branch.imm);
+                        break;
+                case 0xC2: case 0xCA: case 0xD2: case 0xDA: // JP cc
+                        target = branch.imm;
+                        break;
+                default:
+                        return 0;
+        }
+        if (target != block.start) {
+                return 0;
+        }
+
+        for (std::size_t i = 1; i + 1 < ops.size(); i++) {
+                unsigned int index = ops[i].index;
+                bool registerOperand = (index & 0x07) != 0x06; // anything but (HL)
+                bool allowed =
+                        (index >= 0xA0 && index <= 0xBF && registerOperand) || // AND/XOR/OR/CP r
+                        index == 0xE6 || index == 0xEE || index == 0xF6 || index == 0xFE || // AND/XOR/OR/CP n
+                        (index >= 0x140 && index <= 0x17F && registerOperand); // BIT b,r
+                if (!allowed) {
+                        return 0;
+                }
+        }
+
+        return addr;
+}
+
+//! \brief Pass the time an idle polling loop would spend spinning.
+//!
+//! Called with PC back at the start of loop, which findPoll() accepted. Whole
+//! iterations are skipped, up to the first whose read happens at or after the
+//! polled register may change, so timing matches actually running the loop.
+//!
+//! \return the clock after the skipped iterations
+uint64_t Cpu::Impl::skipIdle(const Block &loop, uint64_t now, uint64_t target) {
+        uint64_t change = bus->nextChange(loop.poll, now);
+        if (change == 0) {
+                return now; // The Bus can't tell; run the loop for real.
+        }
+
+        uint64_t until = (change < target) ? change : target;
+        if (cpu->attentionAt < until) {
+                until = cpu->attentionAt; // An interrupt may be due first.
+        }
+        if (until <= now) {
+                return now;
+        }
+
+        uint64_t length = loop.cycles + 4; // plus the taken branch
+        uint64_t iterations = (until - now + length - 1) / length;
+        return now + iterations * length;
+}
+
+//! \brief Execute the instruction at PC outside of any block.
+//! \param now clock as the instruction starts
+//! \return clock cycles taken
+template<typename Timing>
+unsigned int Cpu::Core<Timing>::step(uint64_t now) {
+        DecodedOp op;
+        const Instruction &instruction = decode(cpu->PC, op);
+        imm = op.imm;
+        cpu->PC += op.length;
+        if (PerAccess) {
+                cpu->cycles = now + 4 * op.length;
+        }
+        ((*this).*(instruction.op))();
+
+        unsigned int elapsed = instruction.cycles + takenCycles;
+        takenCycles = 0;
+        return elapsed;
+}
+
+//! \brief Run a single opcode handler on behalf of native code.
+//!
+//! PC and imm must already be set up as runCycles() would.
+template<typename Timing>
+void Cpu::Core<Timing>::Interpret(void *impl, unsigned int index) {
+        assert(index < 0x200); // Superinstructions are split by the Jit.
+        Core *self = static_cast<Core *>(impl);
+        ((*self).*(instructionTable[index].op))();
+        self->materializeFlags(); // Native code keeps F in a host register.
+}
+
+#if defined(GSGB_TRACE)
+//! \brief Record the instruction at PC, before it executes, to cpu->trace.
+void Cpu::Impl::traceOp(unsigned int index, uint64_t cycle) {
+        if (cpu->trace == nullptr) {
+                return;
+        }
+
+        materializeFlags();
+        TraceRecord r;
+        r.cycle = cycle;
+        r.pc = cpu->PC;
+        r.opcode = static_cast<uint16_t>(index < 0x100 ? index : (0xCB00 | (index & 0xFF)));
+        r.af = cpu->registers.r16.AF;
+        r.bc = cpu->registers.r16.BC;
+        r.de = cpu->registers.r16.DE;
+        r.hl = cpu->registers.r16.HL;
+        r.sp = cpu->SP;
+        r.reserved = 0;
+        cpu->trace->record(r);
+}
+#endif
+
+#if defined(GSGB_PROFILE)
+//! \brief Sample cpu->stacks at the instruction in block running when it is due.
+//!
+//! Only the last instruction of a block can call or return, so the shadow
+//! stack is already right for every instruction in it.
+//!
+//! \return when the next sample is due
+uint64_t Cpu::Impl::sampleStack(const Block &block, uint64_t now) {
+        uint16_t pc = block.start;
+        for (const DecodedOp &op : block.ops) {
+                if (now + op.cycles > cpu->stacks->due) {
+                        break;
+                }
+                now += op.cycles;
+                pc += op.length;
+        }
+        cpu->stacks->sample(pc, codeBank(pc), now);
+        return cpu->stacks->due;
+}
+#endif
+
+//! \return the cached block starting at pc, building it if necessary
+template<typename Timing>
+Block *Cpu::Core<Timing>::lookupBlock(uint16_t pc) {
+        uint16_t bank = codeBank(pc);
+        Block *block = cpu->cache->find(pc, bank);
+        if (block == nullptr && cpu->store != nullptr && !PerAccess && pc < 0x8000) {
+                block = loadBlock(pc, bank);
+        }
+        if (block == nullptr) {
+                block = buildBlock(pc, bank);
+        }
+        return block;
+}
+
+//! \brief Copy the block at pc out of cpu->store, if it has one, rather than
+//! decoding it again.
+template<typename Timing>
+Block *Cpu::Core<Timing>::loadBlock(uint16_t pc, uint16_t bank) {
+        std::unique_ptr<Block> block(new Block());
+        if (!cpu->store->load(BlockCache::key(pc, bank), 0x200 + FusionCount, *block)) {
+                return nullptr;
+        }
+
+        // Hot last run, so compile it on its next entry.
+        if (block->hits >= Jit::Threshold) {
+                block->hits = Jit::Threshold - 1;
+        }
+        block->native = cpu->aot->find((pc & 0xC000) == 0x4000 ? bank : 0, *block);
+        return cpu->cache->insert(std::move(block));
 }
 
 //------------------------------------------------------------------------------
 // Public interface
 //------------------------------------------------------------------------------
 
+//! \brief Decode the instruction at PC and advance past it.
+//!
+//! In GSGB_TRACE builds the instruction is also recorded to Cpu::trace, and in
+//! GSGB_PROFILE builds counted in Cpu::profile and sampled by Cpu::stacks.
 void Cpu::instructionFetch() {
-        uint8_t opcodeByte;
-        opcode = 0;
-
-        std::ostream fmt(NULL);
-        fmt.copyfmt(std::cout);
-
-        uint16_t debug_byte_1 = static_cast<uint16_t>(bus->read(PC + 0));
-        uint16_t debug_byte_2 = static_cast<uint16_t>(bus->read(PC + 1));
-        uint16_t debug_byte_3 = static_cast<uint16_t>(bus->read(PC + 2));
-        uint16_t debug_byte_4 = static_cast<uint16_t>(bus->read(PC + 3));
-
-        std::cout << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << debug_byte_1 << " ";
-        std::cout << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << debug_byte_2 << " ";
-        std::cout << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << debug_byte_3 << " ";
-        std::cout << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << debug_byte_4 << " ";
-        std::cout.copyfmt(fmt);
-
-        std::cout << "pc: " << std::uppercase << std::hex << std::setw(2) << std::setfill('0') << PC;
-        opcodeByte = bus->read(PC++);
-
-        // Some opcodes are two-bytes long; these are prefixed with the byte
-        // 0x10 or 0xCB.
-        // NOTE: I'm not sure if these are ordered B1|B2 or B2|B1.
-        //       I'm assuming B1|B2 in this impl but may need to
-        //       follow up on that.
-        if (0x10 == opcodeByte || 0xCB == opcodeByte) {
-                opcode = (opcodeByte << 8);
-                opcodeByte = bus->read(PC++);
+        DecodedOp op;
+        withCore([this, &op](auto *core) {
+                core->instruction = &core->decode(PC, op);
+        });
+        impl->imm = op.imm;
+#if defined(GSGB_TRACE)
+        impl->traceOp(op.index, cycles);
+#endif
+#if defined(GSGB_PROFILE)
+        if (profile != nullptr) {
+                profile->record(op.index, op.cycles);
+        }
+        if (stacks != nullptr && cycles >= stacks->due) {
+                stacks->sample(PC, impl->codeBank(PC), cycles);
+        }
+#endif
+        PC += op.length;
+
+        // 0xCB-prefixed opcodes live in the upper half of the dispatch table.
+        opcode = op.index < 0x100 ? op.index : (0xCB00 | (op.index & 0xFF));
+}
+
+//! \return number of clock cycles taken, including any taken branch penalty
+//!         and interrupt dispatched afterwards
+unsigned int Cpu::instructionExecute() {
+        const uint64_t start = cycles;
+        unsigned int elapsed = withCore([this](auto *core) {
+                if (core->PerAccess) {
+                        cycles += 4 * core->instruction->length; // fetched already
+                }
+                ((*core).*(core->instruction->op))();
+                return core->instruction->cycles;
+        });
+        impl->materializeFlags();
+
+        elapsed += impl->takenCycles;
+        impl->takenCycles = 0;
+        cycles = start + elapsed;
+        if (cycles >= attentionAt) {
+                uint64_t before = cycles;
+                cycles = withCore([this](auto *core) {
+                        return core->serviceInterrupts(cycles);
+                });
+                elapsed += static_cast<unsigned int>(cycles - before);
+        }
+        return elapsed;
+}
+
+//! \brief Expand OP for every dispatch table index, 0x000-0x1FF.
+#define GS_OP_INDICES_16(OP, hi) \
+        OP(hi##0) OP(hi##1) OP(hi##2) OP(hi##3) OP(hi##4) OP(hi##5) OP(hi##6) OP(hi##7) \
+        OP(hi##8) OP(hi##9) OP(hi##A) OP(hi##B) OP(hi##C) OP(hi##D) OP(hi##E) OP(hi##F)
+#define GS_OP_INDICES(OP) \
+        GS_OP_INDICES_16(OP, 0x00) GS_OP_INDICES_16(OP, 0x01) GS_OP_INDICES_16(OP, 0x02) GS_OP_INDICES_16(OP, 0x03) \
+        GS_OP_INDICES_16(OP, 0x04) GS_OP_INDICES_16(OP, 0x05) GS_OP_INDICES_16(OP, 0x06) GS_OP_INDICES_16(OP, 0x07) \
+        GS_OP_INDICES_16(OP, 0x08) GS_OP_INDICES_16(OP, 0x09) GS_OP_INDICES_16(OP, 0x0A) GS_OP_INDICES_16(OP, 0x0B) \
+        GS_OP_INDICES_16(OP, 0x0C) GS_OP_INDICES_16(OP, 0x0D) GS_OP_INDICES_16(OP, 0x0E) GS_OP_INDICES_16(OP, 0x0F) \
+        GS_OP_INDICES_16(OP, 0x10) GS_OP_INDICES_16(OP, 0x11) GS_OP_INDICES_16(OP, 0x12) GS_OP_INDICES_16(OP, 0x13) \
+        GS_OP_INDICES_16(OP, 0x14) GS_OP_INDICES_16(OP, 0x15) GS_OP_INDICES_16(OP, 0x16) GS_OP_INDICES_16(OP, 0x17) \
+        GS_OP_INDICES_16(OP, 0x18) GS_OP_INDICES_16(OP, 0x19) GS_OP_INDICES_16(OP, 0x1A) GS_OP_INDICES_16(OP, 0x1B) \
+        GS_OP_INDICES_16(OP, 0x1C) GS_OP_INDICES_16(OP, 0x1D) GS_OP_INDICES_16(OP, 0x1E) GS_OP_INDICES_16(OP, 0x1F)
+
+#if defined(__GNUC__) && !defined(GSGB_NO_COMPUTED_GOTO)
+#define GS_COMPUTED_GOTO 1
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic" // labels as values
+#else
+#define GS_COMPUTED_GOTO 0
+#endif
+
+// GCC's global common subexpression elimination merges every handler's
+// dispatch tail back into one shared indirect jump; keep them separate.
+#if GS_COMPUTED_GOTO && !defined(__clang__)
+#define GS_DISPATCH_ATTRIBUTES __attribute__((optimize("no-gcse")))
+#else
+#define GS_DISPATCH_ATTRIBUTES
+#endif
+
+//! \brief Run instructions until at least `budget` clock cycles have elapsed.
+//!
+//! Instructions are executed a basic block at a time out of the BlockCache, so
+//! opcodes and immediates are only read from the bus when a block is first
+//! built. The cycle budget is checked between blocks; a block is at most
+//! BlockCache::MaxOps instructions long.
+//!
+//! When jit->enabled is set, ROM blocks entered Jit::Threshold times are
+//! compiled to native code and from then on run as a single call.
+//!
+//! Where the compiler supports labels as values every handler is followed by
+//! its own copy of the dispatch sequence and an indirect jump straight to the
+//! next handler, so the branch predictor sees one indirect branch per opcode
+//! rather than a single shared one. Handlers are called through the constexpr
+//! dispatch table with a constant index, so each call is direct and usually
+//! inlined. Define GSGB_NO_COMPUTED_GOTO to use the portable switch.
+//!
+//! Unless idleSkip is cleared, loops that just poll an I/O register skip ahead
+//! to when the register may change; see Impl::findPoll().
+//!
+//! The cycle counter is published at every block boundary, which is as fresh
+//! as peripherals deriving their state from it get to see. An MCycle Cpu
+//! runs one instruction per block, without native code, superinstructions
+//! or idle skipping, and publishes the clock at each memory access as well;
+//! see Core::read(). While halted, time
+//! skips straight to the next peripheral event; see Impl::haltUntil().
+//! Interrupts are dispatched between blocks too, and only looked for once the
+//! clock reaches attentionAt; see Core::serviceInterrupts().
+//!
+//! \return number of clock cycles actually executed
+unsigned int Cpu::runCycles(unsigned int budget) {
+        return withCore([this, budget](auto *core) {
+                return run(core, budget);
+        });
+}
+
+//! \brief runCycles() for one Core.
+template<typename CoreType>
+GS_DISPATCH_ATTRIBUTES
+unsigned int Cpu::run(CoreType *core, unsigned int budget) {
+        const uint64_t start = cycles;
+        const uint64_t target = start + budget;
+        uint64_t now = start;
+        Block *block = nullptr;
+        const DecodedOp *op = nullptr;
+        const DecodedOp *end = nullptr;
+
+        // Native blocks and skipped idle loops can't be traced or profiled
+        // instruction by instruction.
+#if defined(GSGB_TRACE)
+#define GS_UNTRACED (trace == nullptr)
+#define GS_TRACE_OP() core->traceOp(op->index, now);
+#else
+#define GS_UNTRACED true
+#define GS_TRACE_OP()
+#endif
+#if defined(GSGB_PROFILE)
+        uint64_t sampleDue = (stacks != nullptr) ? stacks->due : UINT64_MAX;
+#define GS_UNPROFILED (profile == nullptr && stacks == nullptr)
+#define GS_PROFILE_OP()                                                 \
+        if (profile != nullptr) {                                       \
+                profile->record(op->index, op->cycles);                 \
+        }
+#define GS_PROFILE_BLOCK()                                              \
+        if (now + block->cycles > sampleDue) {                          \
+                sampleDue = core->sampleStack(*block, now);             \
+        }
+#else
+#define GS_UNPROFILED true
+#define GS_PROFILE_OP()
+#define GS_PROFILE_BLOCK()
+#endif
+#define GS_UNOBSERVED (GS_UNTRACED && GS_UNPROFILED)
+
+        // Skip the rest of an idle loop that is about to go round again.
+        // Stop if out of cycles, otherwise find the block at PC, running it
+        // natively if it has been compiled ahead of time, or by the JIT
+        // while that is enabled. A write to cached RAM code may have retired
+        // the previous block, so this is the only safe place to free it.
+#define GS_ENTER_BLOCK()                                                \
+        next_block:                                                     \
+        now += core->takenCycles;                                       \
+        core->takenCycles = 0;                                          \
+        if (block != nullptr && block->poll != 0 && PC == block->start && \
+            idleSkip && GS_UNOBSERVED && !cache->dirty) {               \
+                now = core->skipIdle(*block, now, target);              \
+        }                                                               \
+        if (core->halted) {                                             \
+                now = core->haltUntil(now, target);                     \
+        }                                                               \
+        if (now >= attentionAt) {                                       \
+                now = core->serviceInterrupts(now);                     \
+        }                                                               \
+        cycles = now;                                                   \
+        if (now >= target) {                                            \
+                goto done;                                              \
+        }                                                               \
+        if (cache->dirty) {                                             \
+                cache->reclaim();                                       \
+        }                                                               \
+        block = core->lookupBlock(PC);                                  \
+        if (block->start < 0x8000 && !CoreType::PerAccess && GS_UNOBSERVED) { \
+                if (block->native == nullptr && jit->enabled &&         \
+                    block->hits < Jit::Threshold && ++block->hits == Jit::Threshold) { \
+                        block->native = jit->compile(*block);           \
+                        block->jitted = block->native != nullptr;       \
+                }                                                       \
+                if (block->native != nullptr && (jit->enabled || !block->jitted)) { \
+                        now += block->cycles;                           \
+                        core->materializeFlags();                       \
+                        block->native();                                \
+                        goto next_block;                                \
+                }                                                       \
+        }                                                               \
+        GS_PROFILE_BLOCK()                                              \
+        op = block->ops.data();                                         \
+        end = op + block->ops.size();
+
+#define GS_BEGIN_OP()                                                   \
+        GS_TRACE_OP()                                                   \
+        GS_PROFILE_OP()                                                 \
+        core->imm = op->imm;                                            \
+        PC += op->length;                                               \
+        if (CoreType::PerAccess) {                                      \
+                cycles = now + 4 * op->length;                          \
+        }                                                               \
+        now += op->cycles;
+
+#define GS_EXECUTE(n) ((*core).*(CoreType::instructionTable[n].op))();
+
+#define GS_EXECUTE_FUSED(id, ...) core->template Op_Fused<__VA_ARGS__>();
+
+#if GS_COMPUTED_GOTO
+#define GS_LABEL_ADDRESS(n) &&op_##n,
+#define GS_FUSED_ADDRESS(id, name, ...) &&fused_##id,
+#define GS_DISPATCH_NEXT()                                              \
+        if (++op == end || cache->dirty) {                              \
+                goto next_block;                                        \
+        }                                                               \
+        GS_BEGIN_OP()                                                   \
+        goto *labels[op->index];
+#define GS_LABEL(n)                                                     \
+        op_##n:                                                         \
+        GS_EXECUTE(n)                                                   \
+        GS_DISPATCH_NEXT()
+#define GS_FUSED_LABEL(id, name, ...)                                   \
+        fused_##id:                                                     \
+        GS_EXECUTE_FUSED(id, __VA_ARGS__)                               \
+        GS_DISPATCH_NEXT()
+
+        static void *const labels[] = {
+                GS_OP_INDICES(GS_LABEL_ADDRESS)
+                GS_FUSIONS(GS_FUSED_ADDRESS)
+        };
+
+        GS_ENTER_BLOCK()
+        GS_BEGIN_OP()
+        goto *labels[op->index];
+        GS_OP_INDICES(GS_LABEL)
+        GS_FUSIONS(GS_FUSED_LABEL)
+
+#undef GS_FUSED_LABEL
+#undef GS_LABEL
+#undef GS_DISPATCH_NEXT
+#undef GS_FUSED_ADDRESS
+#undef GS_LABEL_ADDRESS
+#else
+#define GS_CASE(n) case n: GS_EXECUTE(n) break;
+#define GS_FUSED_CASE(id, name, ...) case 0x200 + id: GS_EXECUTE_FUSED(id, __VA_ARGS__) break;
+
+        GS_ENTER_BLOCK()
+        do {
+                GS_BEGIN_OP()
+                switch (op->index) {
+                        GS_OP_INDICES(GS_CASE)
+                        GS_FUSIONS(GS_FUSED_CASE)
+                }
+        } while (++op != end && !cache->dirty);
+        goto next_block;
+
+#undef GS_FUSED_CASE
+#undef GS_CASE
+#endif
+
+done:
+        core->materializeFlags();
+        return static_cast<unsigned int>(now - start);
+
+#undef GS_EXECUTE_FUSED
+#undef GS_EXECUTE
+#undef GS_BEGIN_OP
+#undef GS_ENTER_BLOCK
+#undef GS_UNOBSERVED
+#undef GS_PROFILE_BLOCK
+#undef GS_PROFILE_OP
+#undef GS_UNPROFILED
+#undef GS_TRACE_OP
+#undef GS_UNTRACED
+}
+
+#if GS_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+#undef GS_DISPATCH_ATTRIBUTES
+
+//! \brief Find or build the block at pc, in the ROM bank currently mapped.
+//!
+//! For tools that need to see code as runCycles() does, eg. gsgb-aot.
+const Block &Cpu::decodeBlock(uint16_t pc) {
+        return *withCore([pc](auto *core) {
+                return core->lookupBlock(pc);
+        });
+}
+
+//! \brief Split a superinstruction back into the ops it replaced.
+//! \return number of ops written to out; 1 for an ordinary op
+unsigned int Cpu::unfuse(const DecodedOp &op, DecodedOp *out) {
+        return Impl::Unfuse(op, out);
+}
+
+//! \return hash of everything that shapes decoded blocks: instruction lengths,
+//!         cycles and block ends, superinstructions, BlockCache::MaxOps and
+//!         the core, as the M-cycle core builds one-instruction blocks.
+//!         A BlockStore saved with another signature is not used.
+uint32_t Cpu::decoderSignature(Accuracy accuracy) {
+        uint32_t hash = 2166136261u; // 32-bit FNV-1a
+        auto mix = [&hash](uint32_t value) {
+                hash = (hash ^ value) * 16777619u;
+        };
+
+        for (const auto &instruction : Core<FastTiming>::instructionTable) {
+                mix(instruction.length);
+                mix(instruction.cycles);
+                mix(instruction.endsBlock ? 1 : 0);
+        }
+        for (unsigned int id = 0; id < Impl::FusionCount; id++) {
+                const Impl::Fusion &f = Impl::fusionTable[id];
+                for (unsigned int j = 0; j < f.count; j++) {
+                        mix(f.ops[j]);
+                }
+                mix(0x10000); // end of fusion
         }
+        mix(BlockCache::MaxOps);
+        mix(Trace::Enabled ? 1 : 0); // Traced builds don't fuse.
+        mix(static_cast<uint32_t>(accuracy));
+        return hash;
+}
 
-        opcode = (opcode | opcodeByte);
-        std::cout << ", opcode: 0x" << std::uppercase << std::hex << std::setw(2) << std::setfill('0') << opcode << " ";
-        std::cout.copyfmt(fmt);
+//! \return mnemonic for opcode, eg. 0x3E or 0xCB37
+const char *Cpu::instructionName(uint16_t opcode) {
+        unsigned int index = opcode & 0xFF;
+        if ((opcode & 0xFF00) == 0xCB00) {
+                index |= 0x100;
+        }
+        return Core<FastTiming>::instructionTable[index].name;
+}
 
-        impl->instruction = std::make_shared<Instruction>(impl->instructionMap[opcode]);
-        std::cout << *(impl->instruction) << std::endl;
+//! \return mnemonic for a dispatch index as counted by Profile: 0x000-0x1FF
+//! are opcodes as in the instruction table, superinstructions follow.
+//! nullptr past the last superinstruction.
+const char *Cpu::dispatchName(unsigned int index) {
+        static_assert(0x200 + Impl::FusionCount <= Profile::Slots, "profile must cover every dispatch index");
+        if (index < 0x200) {
+                return Core<FastTiming>::instructionTable[index].name;
+        }
+        if (index < 0x200 + Impl::FusionCount) {
+                return Impl::fusionTable[index - 0x200].name;
+        }
+        return nullptr;
 }
 
-void Cpu::instructionExecute() {
-        ((*impl).*(impl->instruction->op))();
+//! \brief Run until the end of the current video frame.
+//!
+//! Frames are CyclesPerFrame long counting from reset(), so overshooting one
+//! frame shortens the next rather than drifting.
+//!
+//! \return number of clock cycles actually executed
+unsigned int Cpu::runFrame() {
+        return runCycles(CyclesPerFrame - static_cast<unsigned int>(cycles % CyclesPerFrame));
 }
 
 void Cpu::dumpState() {
+        impl->materializeFlags();
         printf(
                 "\tB:    %02X C:    %02X D:    %02X E:    %02X H:    %02X L:    %02X A:    %02X F:    %02X\n",
                 registers.r8.B,
@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: cpu.hpp
  * Created: 2019-08-29
- * Updated: 2021-01-02
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -65,16 +65,41 @@
 namespace gs {
 
         class Bus;
-        class Instruction;
+        class BlockCache;
+        class Jit;
+        class Aot;
+        struct Block;
+        struct DecodedOp;
+        class Trace;
+        class Profile;
+        class StackProfile;
+        class BlockStore;
 
         class Cpu {
         public:
-                Cpu();
+                //! \brief How closely peripherals follow the CPU.
+                //!
+                //! Fast lets them catch up once per decoded block, which may
+                //! run natively. MCycle runs one instruction at a time and moves
+                //! the clock peripherals see at each of its memory accesses, for
+                //! code that reads LY or STAT mid-instruction and cares about
+                //! the M-cycle it lands on.
+                enum class Accuracy { Fast, MCycle };
+
+                explicit Cpu(Accuracy accuracy = Accuracy::Fast);
                 ~Cpu();
 
+                static const unsigned int CyclesPerFrame = 70224; //!< 154 lines of 456 cycles
+
                 void instructionFetch();
-                void instructionExecute();
-                char *instructionDesc();
+                unsigned int instructionExecute();
+                unsigned int runCycles(unsigned int budget);
+                unsigned int runFrame();
+                static const char *instructionName(uint16_t opcode);
+                static const char *dispatchName(unsigned int index);
+                const Block &decodeBlock(uint16_t pc);
+                static unsigned int unfuse(const DecodedOp &op, DecodedOp *out);
+                static uint32_t decoderSignature(Accuracy accuracy = Accuracy::Fast);
 
                 void flagSet(uint8_t, uint8_t);
                 void flagSet(char, uint8_t);
@@ -114,10 +139,40 @@ namespace gs {
                 uint16_t I; //!< interrupt vector
 
                 uint16_t opcode = 0x0;
+                uint64_t cycles = 0; //!< clock cycles executed since reset()
+
+                //! Interrupts are only looked at once cycles reaches this; see
+                //! raiseAttention().
+                uint64_t attentionAt = 0;
+
+                //! \brief Have the CPU check for interrupts before it goes on.
+                //!
+                //! Called by anything that may make an interrupt due: a request,
+                //! a change to IE or IME, or a change to when a peripheral's next
+                //! event is.
+                void raiseAttention() {
+                        attentionAt = 0;
+                }
+
+                BlockCache *cache; //!< decoded blocks for runCycles()
+                Jit *jit; //!< optional native tier for runCycles(); see jit.hpp
+                Aot *aot; //!< optional ahead-of-time compiled ROM blocks; see aot.hpp
+                Trace *trace = nullptr; //!< not owned; only recorded to in GSGB_TRACE builds
+                Profile *profile = nullptr; //!< not owned; only counted in GSGB_PROFILE builds
+                StackProfile *stacks = nullptr; //!< not owned; only sampled in GSGB_PROFILE builds
+                BlockStore *store = nullptr; //!< not owned; ROM blocks decoded by earlier runs
+                bool idleSkip = true; //!< fast-forward loops polling I/O registers
+
+                const Accuracy accuracy; //!< fixed when the Cpu is built
 
         private:
-                friend class Instruction;
                 class Impl;
+                template<typename Timing> class Core;
+
+                //! \brief Call f with the Core instantiated for accuracy.
+                template<typename F> auto withCore(F f);
+                template<typename CoreType> unsigned int run(CoreType *core, unsigned int budget);
+
                 Bus *bus;
                 Impl *impl;
         };
@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: host/main.cpp
  * Created: 2019-08-29
- * Updated: 2021-01-04
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -10,13 +10,24 @@
  ******************************************************************************/
 //! \file host/main.cpp
 #include <cstdint>
-#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <set>
 #include <vector>
 
 #include "../bus.hpp"
 #include "../cpu.hpp"
 #include "../cartridge.hpp"
+#include "../aot.hpp"
+#include "../block_cache.hpp"
+#include "../block_store.hpp"
+#include "../jit.hpp"
+#include "../trace.hpp"
+#include "../profile.hpp"
+#include "../rom_file.hpp"
+#include "../stack_profile.hpp"
 #include "../video.hpp"
 #include "graphics.hpp"
 #include "input.hpp"
@@ -24,24 +35,49 @@
 using namespace std;
 using namespace gs;
 
+//! \brief Read the global checksums of ROMs that must not have their idle
+//! loops skipped, eg. because they rely on timing the skip doesn't reproduce.
+//!
+//! The file holds one hexadecimal checksum per line. Anything after it, and
+//! any line starting with #, is ignored.
+//! \return false if path can't be read
+static bool readChecksums(const char *path, set<uint16_t> &checksums) {
+        FILE *file = fopen(path, "r");
+        if (file == nullptr) {
+                return false;
+        }
+        char line[256];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+                char *end;
+                unsigned long value = strtoul(line, &end, 16);
+                if (end != line && value <= 0xFFFF) {
+                        checksums.insert(static_cast<uint16_t>(value));
+                }
+        }
+        fclose(file);
+        return true;
+}
+
 int main(int argc, char *argv[]) {
-        Cpu cpu;
+        // The CPU core is chosen as the Cpu is built, ahead of other options.
+        Cpu::Accuracy accuracy = Cpu::Accuracy::Fast;
+        for (int i = 1; i < argc; i++) {
+                if (0 == strcmp(argv[i], "--accurate")) {
+                        accuracy = Cpu::Accuracy::MCycle;
+                }
+        }
+
+        Cpu cpu(accuracy);
         Cartridge *cart = nullptr;
         Bus gb;
         Video video;
         Graphics graphics(std::string("gsgb").c_str(), 160, 144);
         Input input;
 
-        ifstream stream("data/cpu_instrs/individual/03-op sp,hl.gb", ios::in | ios::binary | ios::ate);
-        if (stream.is_open()) {
-                streampos size = stream.tellg();
-                char *buf = new char[size];
-                stream.seekg(0, ios::beg);
-                stream.read(buf, size);
-                stream.close();
-                cart = new Cartridge(reinterpret_cast<uint8_t*>(buf), size);
+        RomFile rom;
+        if (rom.open("data/cpu_instrs/individual/03-op sp,hl.gb")) {
+                cart = new Cartridge(rom.data(), static_cast<unsigned int>(rom.size()));
                 // TODO: Error handling on allocating new cartridge.
-                delete[] buf;
         } else {
                 fputs("Couldn't open rom.\n", stderr);
                 exit(1);
@@ -52,33 +88,140 @@ int main(int argc, char *argv[]) {
         gb.attach(&video);
         gb.reset();
 
+        Trace *trace = nullptr;
+        Profile *profile = nullptr;
+        const char *profilePath = nullptr;
+        StackProfile *stacks = nullptr;
+        const char *stacksPath = nullptr;
+        const char *symbolsPath = nullptr;
+        bool blockStats = false;
+        BlockStore *store = nullptr;
+        const char *storePath = nullptr;
+        for (int i = 1; i < argc; i++) {
+                if (0 == strcmp(argv[i], "--jit")) {
+                        cpu.jit->enabled = true;
+                } else if (0 == strcmp(argv[i], "--aot") && i + 1 < argc) {
+                        if (!cpu.aot->load(argv[i + 1], cart->globalChecksum(), cart->contentHash())) {
+                                fprintf(stderr, "Couldn't load AOT module %s for this ROM.\n", argv[i + 1]);
+                        }
+                        i++;
+                } else if (0 == strcmp(argv[i], "--block-cache") && i + 1 < argc) {
+                        if (store == nullptr) {
+                                store = new BlockStore(cart->globalChecksum(), cart->contentHash(), Cpu::decoderSignature(cpu.accuracy));
+                                storePath = argv[i + 1];
+                                store->open(storePath); // Missing or stale; replaced on exit.
+                                cpu.store = store;
+                        }
+                        i++;
+                } else if (0 == strcmp(argv[i], "--block-stats")) {
+                        blockStats = true;
+                } else if (0 == strcmp(argv[i], "--no-idle-skip")) {
+                        cpu.idleSkip = false;
+                } else if (0 == strcmp(argv[i], "--no-idle-skip-list") && i + 1 < argc) {
+                        set<uint16_t> checksums;
+                        if (!readChecksums(argv[i + 1], checksums)) {
+                                fprintf(stderr, "Couldn't read idle skip list %s.\n", argv[i + 1]);
+                        } else if (checksums.count(cart->globalChecksum()) != 0) {
+                                cpu.idleSkip = false;
+                        }
+                        i++;
+                } else if (0 == strcmp(argv[i], "--trace") && i + 1 < argc) {
+                        if (!Trace::Enabled) {
+                                fputs("Built without GSGB_TRACE; ignoring --trace.\n", stderr);
+                        } else if (trace == nullptr) {
+                                trace = new Trace(argv[i + 1]);
+                                if (!trace->good()) {
+                                        fprintf(stderr, "Couldn't open trace file %s.\n", argv[i + 1]);
+                                        exit(1);
+                                }
+                                cpu.trace = trace;
+                        }
+                        i++;
+                } else if (0 == strcmp(argv[i], "--profile") && i + 1 < argc) {
+                        if (!Profile::Enabled) {
+                                fputs("Built without GSGB_PROFILE; ignoring --profile.\n", stderr);
+                        } else if (profile == nullptr) {
+                                profile = new Profile();
+                                profilePath = argv[i + 1];
+                                Profile::installSignalHandler();
+                                cpu.profile = profile;
+                        }
+                        i++;
+                } else if (0 == strcmp(argv[i], "--profile-stacks") && i + 1 < argc) {
+                        if (!Profile::Enabled) {
+                                fputs("Built without GSGB_PROFILE; ignoring --profile-stacks.\n", stderr);
+                        } else if (stacks == nullptr) {
+                                stacks = new StackProfile();
+                                stacksPath = argv[i + 1];
+                                Profile::installSignalHandler();
+                                cpu.stacks = stacks;
+                        }
+                        i++;
+                } else if (0 == strcmp(argv[i], "--symbols") && i + 1 < argc) {
+                        symbolsPath = argv[i + 1];
+                        i++;
+                }
+        }
+
+        if (stacks != nullptr && symbolsPath != nullptr && !stacks->loadSymbols(symbolsPath)) {
+                fprintf(stderr, "Couldn't read symbols from %s.\n", symbolsPath);
+        }
+
+        auto writeProfiles = [&]() {
+                if (profile != nullptr && !profile->write(profilePath)) {
+                        fprintf(stderr, "Couldn't write profile %s.\n", profilePath);
+                }
+                if (stacks != nullptr && !stacks->write(stacksPath)) {
+                        fprintf(stderr, "Couldn't write profile %s.\n", stacksPath);
+                }
+        };
+
         bool running = true;
-        vector<char> buf;
+        vector<char> line;
         while (running) {
-                // TODO: Simulate frequency
                 graphics.begin();
                 graphics.clear(0xFFFFFFFF);
                 input.process();
                 running = !input.isQuitRequested();
 
-                cpu.instructionFetch();
-                cpu.dumpState();
-                cpu.instructionExecute();
+                cpu.runFrame();
+
+                if (Profile::dumpRequested.exchange(false)) {
+                        writeProfiles();
+                }
 
-                if (gb.memRegisters.sc == 0x81) {
-                        cout << "hi" << endl;
-                        char byte = static_cast<char>(gb.memRegisters.sb);
-                        buf.push_back(byte);
+                for (char byte : gb.serialOut) {
+                        line.push_back(byte);
                         if (byte == '\n') {
-                                for (auto it = buf.begin(); it != buf.end(); it++) {
-                                        cout << *it;
-                                }
-                                buf.clear();
+                                cout.write(line.data(), line.size());
+                                line.clear();
                         }
                 }
+                gb.serialOut.clear();
 
                 graphics.end();
         }
 
+        cpu.trace = nullptr;
+        delete trace;
+
+        if (blockStats) {
+                fprintf(stderr, "Writes to RAM code pages: %llu; blocks invalidated: %llu.\n",
+                        static_cast<unsigned long long>(cpu.cache->stats.codeWrites),
+                        static_cast<unsigned long long>(cpu.cache->stats.blocksInvalidated));
+        }
+
+        if (store != nullptr && !store->save(storePath, *cpu.cache)) {
+                fprintf(stderr, "Couldn't write block cache %s.\n", storePath);
+        }
+        cpu.store = nullptr;
+        delete store;
+
+        cpu.profile = nullptr;
+        cpu.stacks = nullptr;
+        writeProfiles();
+        delete profile;
+        delete stacks;
+
         return 0;
 }
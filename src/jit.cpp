@@ -0,0 +1,785 @@
+/******************************************************************************
+ * File: jit.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file jit.cpp
+#include <cassert>
+#include <cstring>
+
+#include "jit.hpp"
+#include "block_cache.hpp"
+#include "bus.hpp"
+#include "cpu.hpp"
+
+#if defined(__x86_64__) && defined(__unix__) && !defined(GSGB_NO_JIT)
+#define GS_JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define GS_JIT_X86_64 0
+#endif
+
+namespace gs {
+
+#if GS_JIT_X86_64
+
+//-----------------------------------------------------------------------------
+// Register Assignment
+//-----------------------------------------------------------------------------
+
+// Host registers, numbered as in the x86-64 ModRM encoding.
+enum Host {
+        RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+        R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+// Guest registers in opcode encoding order: B, C, D, E, H, L, (HL), A.
+// Each lives zero-extended in a 32-bit host register. B-E and A use
+// callee-saved registers so they survive calls into the Bus; H, L and F
+// are saved around those calls. R15 holds the address of Cpu::registers.
+static const int hostReg[8] = { R13, R14, RBX, RBP, R8, R9, -1, R12 };
+static const int hostF = R10;
+
+using R8Regs = decltype(Cpu::registers.r8);
+static const uint8_t guestOffset[8] = {
+        offsetof(R8Regs, B), offsetof(R8Regs, C), offsetof(R8Regs, D), offsetof(R8Regs, E),
+        offsetof(R8Regs, H), offsetof(R8Regs, L), 0, offsetof(R8Regs, A)
+};
+static const uint8_t guestOffsetF = offsetof(R8Regs, F);
+
+// Flag bits in Cpu::registers.r8.F. These match the low byte of RFLAGS.
+static const uint32_t FlagZ = 0x40;
+static const uint32_t FlagH = 0x10;
+static const uint32_t FlagN = 0x02;
+static const uint32_t FlagC = 0x01;
+
+static uint8_t Read(Bus *bus, uint16_t addr) {
+        return bus->read(addr);
+}
+
+static void Write(Bus *bus, uint16_t addr, uint8_t value) {
+        bus->write(addr, value);
+}
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Assembler
+//-----------------------------------------------------------------------------
+
+//! \brief Minimal x86-64 encoder for the handful of forms the translator uses.
+class Assembler {
+public:
+        Assembler(std::vector<uint8_t> &out) : out(out) {}
+
+        void byte(uint8_t b) {
+                out.push_back(b);
+        }
+
+        void dword(uint32_t d) {
+                for (int i = 0; i < 4; i++) {
+                        byte(static_cast<uint8_t>(d >> (i * 8)));
+                }
+        }
+
+        void qword(uint64_t q) {
+                for (int i = 0; i < 8; i++) {
+                        byte(static_cast<uint8_t>(q >> (i * 8)));
+                }
+        }
+
+        //! REX prefix; byte operations always need one to reach SIL, DIL, BPL.
+        void rex(bool w, int reg, int rm, bool force) {
+                uint8_t value = 0x40 | (w << 3) | ((reg >> 3) << 2) | (rm >> 3);
+                if (value != 0x40 || force) {
+                        byte(value);
+                }
+        }
+
+        void modrm(int reg, int rm) {
+                byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+        }
+
+        //! mov dst32, src32
+        void mov(int dst, int src) {
+                rex(false, src, dst, false);
+                byte(0x89);
+                modrm(src, dst);
+        }
+
+        //! mov dst32, imm32
+        void movImm(int dst, uint32_t imm) {
+                rex(false, 0, dst, false);
+                byte(0xB8 + (dst & 7));
+                dword(imm);
+        }
+
+        //! movabs dst64, imm64
+        void movAbs(int dst, const void *ptr) {
+                rex(true, 0, dst, true);
+                byte(0xB8 + (dst & 7));
+                qword(reinterpret_cast<uint64_t>(ptr));
+        }
+
+        //! movzx dst32, src8
+        void movzx8(int dst, int src) {
+                rex(false, dst, src, true);
+                byte(0x0F);
+                byte(0xB6);
+                modrm(dst, src);
+        }
+
+        //! movzx dst32, src16
+        void movzx16(int dst, int src) {
+                rex(false, dst, src, false);
+                byte(0x0F);
+                byte(0xB7);
+                modrm(dst, src);
+        }
+
+        //! \param opcode the r/m8, r8 form: 0x00 add, 0x10 adc, 0x28 sub, ...
+        void alu8(uint8_t opcode, int dst, int src) {
+                rex(false, src, dst, true);
+                byte(opcode);
+                modrm(src, dst);
+        }
+
+        //! \param digit the /digit of the r/m8, imm8 form
+        void alu8Imm(int digit, int dst, uint8_t imm) {
+                rex(false, 0, dst, true);
+                byte(0x80);
+                modrm(digit, dst);
+                byte(imm);
+        }
+
+        //! \param digit the /digit of the r/m32, imm32 form: 0 add, 1 or, 4 and
+        void alu32Imm(int digit, int dst, uint32_t imm) {
+                rex(false, 0, dst, false);
+                byte(0x81);
+                modrm(digit, dst);
+                dword(imm);
+        }
+
+        //! or dst32, src32
+        void or32(int dst, int src) {
+                rex(false, src, dst, false);
+                byte(0x09);
+                modrm(src, dst);
+        }
+
+        //! inc or dec r8
+        void incDec8(int dst, bool dec) {
+                rex(false, 0, dst, true);
+                byte(0xFE);
+                modrm(dec ? 1 : 0, dst);
+        }
+
+        //! \param digit 4 shl, 5 shr
+        void shift32(int digit, int dst, uint8_t count) {
+                rex(false, 0, dst, false);
+                byte(0xC1);
+                modrm(digit, dst);
+                byte(count);
+        }
+
+        //! bt src32, bit; copies the bit into CF
+        void bt(int src, uint8_t bit) {
+                rex(false, 0, src, false);
+                byte(0x0F);
+                byte(0xBA);
+                modrm(4, src);
+                byte(bit);
+        }
+
+        //! pushfq; pop rax
+        void flagsToRax() {
+                byte(0x9C);
+                byte(0x58);
+        }
+
+        //! mov byte [r15 + disp], src8
+        void store8(uint8_t disp, int src) {
+                rex(false, src, R15, true);
+                byte(0x88);
+                byte(0x40 | ((src & 7) << 3) | (R15 & 7));
+                byte(disp);
+        }
+
+        //! movzx dst32, byte [r15 + disp]
+        void load8(int dst, uint8_t disp) {
+                rex(false, dst, R15, true);
+                byte(0x0F);
+                byte(0xB6);
+                byte(0x40 | ((dst & 7) << 3) | (R15 & 7));
+                byte(disp);
+        }
+
+        //! mov dword [ptr], imm32; clobbers rax
+        void storeDword(const void *ptr, uint32_t imm) {
+                movAbs(RAX, ptr);
+                byte(0xC7);
+                byte(0x00);
+                byte(static_cast<uint8_t>(imm));
+                byte(static_cast<uint8_t>(imm >> 8));
+                byte(static_cast<uint8_t>(imm >> 16));
+                byte(static_cast<uint8_t>(imm >> 24));
+        }
+
+        //! mov word [ptr], imm16; clobbers rax
+        void storeWord(const void *ptr, uint16_t imm) {
+                movAbs(RAX, ptr);
+                byte(0x66);
+                byte(0xC7);
+                byte(0x00);
+                byte(static_cast<uint8_t>(imm));
+                byte(static_cast<uint8_t>(imm >> 8));
+        }
+
+        //! call fn; clobbers rax
+        void call(const void *fn) {
+                movAbs(RAX, fn);
+                byte(0xFF);
+                byte(0xD0);
+        }
+
+        //! mov dst64, qword [base + index * 8]
+        void loadTable(int dst, int base, int index) {
+                rex(true, dst, base, false);
+                if (index >= 8) {
+                        out.back() |= 0x02; // REX.X
+                }
+                byte(0x8B);
+                byte(0x04 | ((dst & 7) << 3));
+                byte(0xC0 | ((index & 7) << 3) | (base & 7));
+        }
+
+        //! movzx dst32, byte [base + index]; base must not be rbp or r13
+        void loadIndexed8(int dst, int base, int index) {
+                rex(false, dst, base, true);
+                out.back() |= (index >> 3) << 1;
+                byte(0x0F);
+                byte(0xB6);
+                byte(0x04 | ((dst & 7) << 3));
+                byte(((index & 7) << 3) | (base & 7));
+        }
+
+        //! mov byte [base + index], src8; base must not be rbp or r13
+        void storeIndexed8(int base, int index, int src) {
+                rex(false, src, base, true);
+                out.back() |= (index >> 3) << 1;
+                byte(0x88);
+                byte(0x04 | ((src & 7) << 3));
+                byte(((index & 7) << 3) | (base & 7));
+        }
+
+        //! test src64, src64
+        void test64(int src) {
+                rex(true, src, src, false);
+                byte(0x85);
+                modrm(src, src);
+        }
+
+        //! bt src64, bit64; copies bit (mod 64) of src into CF
+        void bt64(int src, int bit) {
+                rex(true, bit, src, false);
+                byte(0x0F);
+                byte(0xA3);
+                modrm(bit, src);
+        }
+
+        //! jcc rel8 with the displacement left for bind()
+        //! \param cc condition code: 2 b/c, 4 e/z, or -1 for jmp
+        //! \return position of the displacement
+        std::size_t jumpShort(int cc) {
+                byte(cc < 0 ? 0xEB : 0x70 + cc);
+                byte(0);
+                return out.size() - 1;
+        }
+
+        //! Point the jump whose displacement is at at the next instruction.
+        void bind(std::size_t at) {
+                std::size_t distance = out.size() - (at + 1);
+                assert(distance < 0x80);
+                out[at] = static_cast<uint8_t>(distance);
+        }
+
+        void push(int reg) {
+                rex(false, 0, reg, false);
+                byte(0x50 + (reg & 7));
+        }
+
+        void pop(int reg) {
+                rex(false, 0, reg, false);
+                byte(0x58 + (reg & 7));
+        }
+
+        //! sub or add rsp, 8
+        void adjustStack(bool reserve) {
+                byte(0x48);
+                byte(0x83);
+                byte(reserve ? 0xEC : 0xC4);
+                byte(0x08);
+        }
+
+        void ret() {
+                byte(0xC3);
+        }
+
+private:
+        std::vector<uint8_t> &out;
+};
+
+//-----------------------------------------------------------------------------
+// Translator
+//-----------------------------------------------------------------------------
+
+//! \brief Emits one block, tracking whether guest registers are in the host
+//! registers or have been written back to Cpu::registers.
+class Translator {
+public:
+        Translator(std::vector<uint8_t> &out, const Jit::Hooks &hooks, Bus *bus)
+                : as(out), hooks(hooks), bus(bus) {}
+
+        //! \return whether index is translated rather than interpreted
+        static bool Supported(unsigned int index) {
+                if (index >= 0x100) {
+                        return false;
+                }
+                if (index == 0x00 || (index >= 0x40 && index < 0xC0 && index != 0x76)) {
+                        return true; // NOP, LD r,r', ALU A,r
+                }
+                switch (index & 0xC7) {
+                        case 0x04: case 0x05: // INC r, DEC r
+                                return index != 0x34 && index != 0x35;
+                        case 0x06: case 0xC6: // LD r,n; ALU A,#
+                                return true;
+                }
+                switch (index) {
+                        case 0x01: case 0x11: case 0x21: // LD rr,##
+                        case 0x03: case 0x13: case 0x23: // INC rr
+                        case 0x0B: case 0x1B: case 0x2B: // DEC rr
+                        case 0x02: case 0x12: case 0x0A: case 0x1A: // LD (rr),A; LD A,(rr)
+                        case 0x22: case 0x32: case 0x2A: case 0x3A: // LDI, LDD
+                        case 0xE0: case 0xF0: case 0xE2: case 0xF2: // LDH
+                        case 0xEA: case 0xFA: // LD (##),A; LD A,(##)
+                                return true;
+                }
+                return false;
+        }
+
+        void prologue() {
+                as.push(RBX);
+                as.push(RBP);
+                as.push(R12);
+                as.push(R13);
+                as.push(R14);
+                as.push(R15);
+                as.adjustStack(true); // keep rsp 16-byte aligned for calls
+                as.movAbs(R15, hooks.registers);
+                spilled = true;
+        }
+
+        //! \param pc address following the block's last instruction
+        void epilogue(bool interpretedLast, uint16_t pc) {
+                if (!spilled) {
+                        spill();
+                }
+                if (!interpretedLast) {
+                        as.storeWord(hooks.pc, pc);
+                }
+                as.adjustStack(false);
+                as.pop(R15);
+                as.pop(R14);
+                as.pop(R13);
+                as.pop(R12);
+                as.pop(RBP);
+                as.pop(RBX);
+                as.ret();
+        }
+
+        //! Hand one instruction to the interpreter's opcode handler.
+        //! \param pc address following the instruction
+        void interpret(const DecodedOp &op, uint16_t pc) {
+                if (!spilled) {
+                        spill();
+                }
+                as.storeWord(hooks.pc, pc);
+                as.storeDword(hooks.imm, op.imm);
+                as.movAbs(RDI, hooks.impl);
+                as.movImm(RSI, op.index);
+                as.call(reinterpret_cast<const void *>(hooks.interpret));
+        }
+
+        void translate(const DecodedOp &op) {
+                if (spilled) {
+                        reload();
+                }
+
+                unsigned int i = op.index;
+                int A = hostReg[7];
+
+                if (i == 0x00) {
+                        return;
+                }
+                if (i >= 0x40 && i < 0x80) {
+                        int dst = (i >> 3) & 7;
+                        int src = i & 7;
+                        if (dst == 6) {
+                                pairAddress(RSI, 4);
+                                as.mov(RDX, hostReg[src]);
+                                write();
+                        } else if (src == 6) {
+                                pairAddress(RSI, 4);
+                                read(hostReg[dst]);
+                        } else if (dst != src) {
+                                as.mov(hostReg[dst], hostReg[src]);
+                        }
+                        return;
+                }
+                if (i >= 0x80 && i < 0xC0) {
+                        int src = i & 7;
+                        if (src == 6) {
+                                pairAddress(RSI, 4);
+                                read(RCX);
+                                alu((i >> 3) & 7, RCX);
+                        } else {
+                                alu((i >> 3) & 7, hostReg[src]);
+                        }
+                        return;
+                }
+
+                switch (i & 0xC7) {
+                        case 0x04:
+                        case 0x05: {
+                                bool dec = (i & 1) != 0;
+                                as.incDec8(hostReg[(i >> 3) & 7], dec);
+                                // INC/DEC leave C alone, as do the x86 forms.
+                                mergeFlags(FlagZ | FlagN | FlagH, FlagZ | FlagH, dec ? FlagN : 0);
+                                return;
+                        }
+                        case 0x06: {
+                                int dst = (i >> 3) & 7;
+                                if (dst == 6) {
+                                        pairAddress(RSI, 4);
+                                        as.movImm(RDX, op.imm & 0xFF);
+                                        write();
+                                } else {
+                                        as.movImm(hostReg[dst], op.imm & 0xFF);
+                                }
+                                return;
+                        }
+                        case 0xC6:
+                                aluImm((i >> 3) & 7, static_cast<uint8_t>(op.imm));
+                                return;
+                }
+
+                switch (i) {
+                        case 0x01: case 0x11: case 0x21:
+                                as.movImm(hostReg[(i >> 4) * 2], op.imm >> 8);
+                                as.movImm(hostReg[(i >> 4) * 2 + 1], op.imm & 0xFF);
+                                return;
+                        case 0x03: case 0x13: case 0x23:
+                                pairAdd((i >> 4) * 2, 1);
+                                return;
+                        case 0x0B: case 0x1B: case 0x2B:
+                                pairAdd((i >> 4) * 2, -1);
+                                return;
+                        case 0x02: case 0x12:
+                                pairAddress(RSI, (i >> 4) * 2);
+                                as.mov(RDX, A);
+                                write();
+                                return;
+                        case 0x0A: case 0x1A:
+                                pairAddress(RSI, (i >> 4) * 2);
+                                read(A);
+                                return;
+                        case 0x22: case 0x32:
+                                pairAddress(RSI, 4);
+                                as.mov(RDX, A);
+                                write();
+                                pairAdd(4, i == 0x22 ? 1 : -1);
+                                return;
+                        case 0x2A: case 0x3A:
+                                pairAddress(RSI, 4);
+                                read(A);
+                                pairAdd(4, i == 0x2A ? 1 : -1);
+                                return;
+                        case 0xE0:
+                                as.movImm(RSI, 0xFF00 | (op.imm & 0xFF));
+                                as.mov(RDX, A);
+                                write();
+                                return;
+                        case 0xF0:
+                                as.movImm(RSI, 0xFF00 | (op.imm & 0xFF));
+                                read(A);
+                                return;
+                        case 0xE2:
+                                as.mov(RSI, hostReg[1]);
+                                as.alu32Imm(1, RSI, 0xFF00);
+                                as.mov(RDX, A);
+                                write();
+                                return;
+                        case 0xF2:
+                                as.mov(RSI, hostReg[1]);
+                                as.alu32Imm(1, RSI, 0xFF00);
+                                read(A);
+                                return;
+                        case 0xEA:
+                                as.movImm(RSI, op.imm);
+                                as.mov(RDX, A);
+                                write();
+                                return;
+                        case 0xFA:
+                                as.movImm(RSI, op.imm);
+                                read(A);
+                                return;
+                }
+
+                assert(false && "translate() called for unsupported opcode");
+        }
+
+private:
+        void spill() {
+                for (int r = 0; r < 8; r++) {
+                        if (hostReg[r] >= 0) {
+                                as.store8(guestOffset[r], hostReg[r]);
+                        }
+                }
+                as.store8(guestOffsetF, hostF);
+                spilled = true;
+        }
+
+        void reload() {
+                for (int r = 0; r < 8; r++) {
+                        if (hostReg[r] >= 0) {
+                                as.load8(hostReg[r], guestOffset[r]);
+                        }
+                }
+                as.load8(hostF, guestOffsetF);
+                spilled = false;
+        }
+
+        //! \param hi encoding index of the pair's high register: 0 BC, 2 DE, 4 HL
+        void pairAddress(int dst, int hi) {
+                as.mov(dst, hostReg[hi]);
+                as.shift32(4, dst, 8);
+                as.or32(dst, hostReg[hi + 1]);
+        }
+
+        void pairAdd(int hi, int delta) {
+                pairAddress(RCX, hi);
+                as.alu32Imm(0, RCX, static_cast<uint32_t>(delta));
+                as.movzx16(RCX, RCX);
+                as.movzx8(hostReg[hi + 1], RCX);
+                as.shift32(5, RCX, 8);
+                as.mov(hostReg[hi], RCX);
+        }
+
+        //! Call into the Bus, preserving the caller-saved guest registers.
+        void callBus(const void *fn) {
+                as.push(R8);
+                as.push(R9);
+                as.push(R10);
+                as.adjustStack(true);
+                as.movAbs(RDI, bus);
+                as.call(fn);
+                as.adjustStack(false);
+                as.pop(R10);
+                as.pop(R9);
+                as.pop(R8);
+        }
+
+        //! Leave the page table entry for the address in esi in rdi and
+        //! the offset into that page in eax, jumping if it is null.
+        //! \return the jump, for bind()
+        std::size_t lookupPage(const void *table) {
+                as.movAbs(RDI, table);
+                as.mov(RAX, RSI);
+                as.shift32(5, RAX, Bus::PageShift);
+                as.loadTable(RDI, RDI, RAX);
+                as.movzx8(RAX, RSI);
+                as.test64(RDI);
+                return as.jumpShort(4);
+        }
+
+        //! Read the byte addressed by esi into dst. Pages in the Bus's
+        //! table are read inline; the rest call Bus::read().
+        void read(int dst) {
+                std::size_t slow = lookupPage(bus->readTable());
+                as.loadIndexed8(dst, RDI, RAX);
+                std::size_t done = as.jumpShort(-1);
+                as.bind(slow);
+                callBus(reinterpret_cast<const void *>(&Read));
+                as.movzx8(dst, RAX);
+                as.bind(done);
+        }
+
+        //! Write dl to the address in esi. As read(), but pages holding
+        //! cached code also take Bus::write() so their blocks are dropped.
+        void write() {
+                std::size_t slow = lookupPage(bus->writeTable());
+                std::size_t code = 0;
+                if (bus->codeCache() != nullptr) {
+                        as.movAbs(R11, bus->codeCache()->codePageBits());
+                        as.mov(RCX, RSI);
+                        as.shift32(5, RCX, Bus::PageShift + 6);
+                        as.loadTable(R11, R11, RCX);
+                        as.mov(RCX, RSI);
+                        as.shift32(5, RCX, Bus::PageShift);
+                        as.bt64(R11, RCX);
+                        code = as.jumpShort(2);
+                }
+                as.storeIndexed8(RDI, RAX, RDX);
+                std::size_t done = as.jumpShort(-1);
+                as.bind(slow);
+                if (bus->codeCache() != nullptr) {
+                        as.bind(code);
+                }
+                callBus(reinterpret_cast<const void *>(&Write));
+                as.bind(done);
+        }
+
+        //! F = (F & ~clear) | (host flags & take) | set
+        void mergeFlags(uint32_t clear, uint32_t take, uint32_t set) {
+                as.flagsToRax();
+                as.alu32Imm(4, RAX, take);
+                as.alu32Imm(4, hostF, ~clear & 0xFF);
+                as.or32(hostF, RAX);
+                if (set) {
+                        as.alu32Imm(1, hostF, set);
+                }
+        }
+
+        //! \param op ALU operation in opcode order: ADD ADC SUB SBC AND XOR OR CP
+        void aluFlags(int op) {
+                if (op >= 4 && op <= 6) {
+                        mergeFlags(FlagZ | FlagN | FlagH | FlagC, FlagZ, 0);
+                } else {
+                        bool subtract = op == 2 || op == 3 || op == 7;
+                        mergeFlags(FlagZ | FlagN | FlagH | FlagC, FlagZ | FlagH | FlagC, subtract ? FlagN : 0);
+                }
+        }
+
+        void alu(int op, int src) {
+                static const uint8_t opcodes[8] = { 0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38 };
+                if (op == 1 || op == 3) {
+                        as.bt(hostF, 0); // guest C into host CF
+                }
+                as.alu8(opcodes[op], hostReg[7], src);
+                aluFlags(op);
+        }
+
+        void aluImm(int op, uint8_t imm) {
+                static const int digits[8] = { 0, 2, 5, 3, 4, 6, 1, 7 };
+                if (op == 1 || op == 3) {
+                        as.bt(hostF, 0);
+                }
+                as.alu8Imm(digits[op], hostReg[7], imm);
+                aluFlags(op);
+        }
+
+        Assembler as;
+        const Jit::Hooks &hooks;
+        Bus *bus;
+        bool spilled = true;
+};
+
+} // namespace
+
+#endif // GS_JIT_X86_64
+
+//-----------------------------------------------------------------------------
+// Jit
+//-----------------------------------------------------------------------------
+
+Jit::Jit(const Hooks &hooks) : hooks(hooks) {
+#if GS_JIT_X86_64
+        // Reserved inaccessible; compile() opens pages for writing only while
+        // it copies code in, so no page is ever writable and executable.
+        void *memory = mmap(nullptr, ArenaSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory != MAP_FAILED) {
+                arena = static_cast<uint8_t *>(memory);
+        }
+#endif
+}
+
+Jit::~Jit() {
+#if GS_JIT_X86_64
+        if (arena != nullptr) {
+                munmap(arena, ArenaSize);
+        }
+#endif
+}
+
+Jit::Native Jit::compile(const Block &block) {
+#if GS_JIT_X86_64
+        if (arena == nullptr || bus == nullptr) {
+                return nullptr;
+        }
+
+        ops.clear();
+        for (const DecodedOp &op : block.ops) {
+                DecodedOp parts[4];
+                unsigned int count = hooks.unfuse(op, parts);
+                ops.insert(ops.end(), parts, parts + count);
+        }
+
+        unsigned int translated = 0;
+        for (const DecodedOp &op : ops) {
+                translated += Translator::Supported(op.index) ? 1 : 0;
+        }
+        if (translated == 0) {
+                return nullptr;
+        }
+
+        code.clear();
+        Translator translator(code, hooks, bus);
+        translator.prologue();
+
+        uint16_t pc = block.start;
+        bool interpretedLast = false;
+        for (const DecodedOp &op : ops) {
+                pc += op.length;
+                interpretedLast = !Translator::Supported(op.index);
+                if (interpretedLast) {
+                        translator.interpret(op, pc);
+                } else {
+                        translator.translate(op);
+                }
+        }
+        translator.epilogue(interpretedLast, pc);
+
+        if (used + code.size() > ArenaSize) {
+                return nullptr; // Out of space; the interpreter keeps this block.
+        }
+
+        // Pages shared with earlier blocks hold code that isn't running:
+        // native code never calls back into compile().
+        uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uint8_t *native = arena + used;
+        uint8_t *first = reinterpret_cast<uint8_t *>(reinterpret_cast<uintptr_t>(native) & ~(pageSize - 1));
+        std::size_t length = static_cast<std::size_t>(native + code.size() - first);
+        if (0 != mprotect(first, length, PROT_READ | PROT_WRITE)) {
+                return nullptr;
+        }
+        memcpy(native, code.data(), code.size());
+        if (0 != mprotect(first, length, PROT_READ | PROT_EXEC)) {
+                return nullptr;
+        }
+        __builtin___clear_cache(reinterpret_cast<char *>(native), reinterpret_cast<char *>(native + code.size()));
+        used += code.size();
+
+        return reinterpret_cast<Native>(native);
+#else
+        (void)block;
+        return nullptr;
+#endif
+}
+
+} // namespace gs
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * File: jit.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file jit.hpp
+//!
+//! Optional x86-64 recompiler for hot ROM blocks.
+//!
+//! Cpu::runCycles() counts how often each cached ROM block is entered; once a block
+//! reaches Threshold it is translated to native code. Guest registers A-L and
+//! F live in host registers for the duration of the block. Loads, ALU ops,
+//! INC/DEC and memory accesses through the Bus are translated; anything else,
+//! including the control transfer that ends the block, is handed back to the
+//! interpreter's opcode handler. Blocks with nothing worth translating are
+//! left to the interpreter entirely. Superinstructions are split back into
+//! their parts first, so each part can be translated.
+//!
+//! Memory accesses index the Bus's page table inline, as Bus::read() and
+//! Bus::write() do, and only call into the Bus for pages without an entry
+//! or, for writes, pages holding cached code.
+//!
+//! The code arena is never writable and executable at once: pages are made
+//! writable only while a block is copied in, then executable again.
+//!
+//! The translator only exists on x86-64 Unix hosts; elsewhere, or when built
+//! with GSGB_NO_JIT, compile() always fails and the interpreter runs.
+#ifndef JIT_VERSION
+#define JIT_VERSION "0.1.0" //!< include guard
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gs {
+
+        class Bus;
+        struct Block;
+        struct DecodedOp;
+
+        class Jit {
+        public:
+                typedef void (*Native)();
+
+                //! Interpreter entry points and guest state used by translated code.
+                struct Hooks {
+                        uint8_t *registers; //!< Cpu::registers
+                        uint16_t *pc; //!< Cpu::PC
+                        uint32_t *imm; //!< immediate operand read by opcode handlers
+                        void *impl; //!< first argument to interpret
+                        void (*interpret)(void *impl, unsigned int index); //!< run one opcode handler
+                        unsigned int (*unfuse)(const DecodedOp &op, DecodedOp *out); //!< split a superinstruction into up to 4 ops
+                };
+
+                static const uint32_t Threshold = 32; //!< block entries before compiling
+                static const std::size_t ArenaSize = 4 * 1024 * 1024; //!< bytes of native code
+
+                Jit(const Hooks &hooks);
+                ~Jit();
+
+                //! \return native code for block, or nullptr to keep interpreting it
+                Native compile(const Block &block);
+
+                Bus *bus = nullptr;
+                bool enabled = false; //!< may be toggled between calls to Cpu::runCycles()
+
+        private:
+                Hooks hooks;
+                uint8_t *arena = nullptr;
+                std::size_t used = 0;
+                std::vector<uint8_t> code; //!< block being assembled
+                std::vector<DecodedOp> ops; //!< block being translated, superinstructions split
+        };
+
+} // namespace gs
+
+#endif // JIT_VERSION
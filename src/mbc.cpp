@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: mbc.cpp
  * Created: 2020-12-28
- * Updated: 2020-12-30
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -10,17 +10,30 @@
  ******************************************************************************/
 //! \file mbc.cpp
 #include <cassert>
-#include <cstdio>
 
 #include "mbc.hpp"
 
 namespace gs {
         static const uint32_t BANK_SIZE = 16 * 1024;
+        static const uint32_t RAM_BANK_SIZE = 8 * 1024;
 
         /**********************************************************************
          * Mbc
          **********************************************************************/
-        Mbc::~Mbc() {}
+        Mbc::~Mbc() {
+                delete[] rom_copy;
+        }
+
+        const uint8_t *Mbc::referenceRom(const uint8_t *data, uint32_t size, uint32_t rom_size) {
+                if (size >= rom_size) {
+                        return data;
+                }
+                rom_copy = new uint8_t[rom_size];
+                for (uint32_t i = 0; i < rom_size; ++i) {
+                        rom_copy[i] = (i < size) ? data[i] : 0xFF;
+                }
+                return rom_copy;
+        }
 
         /**********************************************************************
          * MbcNone
@@ -45,7 +58,7 @@ namespace gs {
 
         bool MbcNone::write(uint16_t addr, uint8_t value) {
                 if (addr >= 0x0000 && addr <= 0x7FFF) {
-                        rom[addr] = value;
+                        // ROM is read-only; there are no registers to write.
                         return true;
                 } else if (addr >= 0xA000 && addr <= 0xBFFF) {
                         assert(addr <= ram_size + 0xA000);
@@ -71,10 +84,27 @@ namespace gs {
                 return false;
         }
 
-        void MbcNone::loadRom(uint8_t *data) {
-                for (uint32_t i = 0; i < rom_size; ++i) {
-                        rom[i] = data[i];
+        void MbcNone::loadRom(const uint8_t *data, uint32_t size) {
+                rom = referenceRom(data, size, rom_size);
+        }
+
+        uint16_t MbcNone::romBank() const {
+                return 1;
+        }
+
+        const uint8_t *MbcNone::readPage(uint16_t addr) {
+                if (addr <= 0x7FFF) {
+                        return &rom[addr & 0xFF00];
                 }
+                return writePage(addr);
+        }
+
+        uint8_t *MbcNone::writePage(uint16_t addr) {
+                uint32_t offset = static_cast<uint32_t>(addr & 0xFF00) - 0xA000;
+                if (addr >= 0xA000 && addr <= 0xBFFF && offset < ram_size) {
+                        return &ram[offset];
+                }
+                return nullptr;
         }
 
         /**********************************************************************
@@ -89,7 +119,6 @@ namespace gs {
                 // The RAM can only be 0kb, 2kb, 8kb or 32kb.
                 assert(ram_size == 0 || ram_size == (2 * 1024) || ram_size == (8 * 1024) || ram_size == (32 * 1024));
 
-                this->rom = new uint8_t[rom_size];
                 this->rom_size = rom_size;
 
                 this->ram = new uint8_t[ram_size];
@@ -97,24 +126,51 @@ namespace gs {
 
                 ram_enabled = false;
                 mem_mode = MemoryModeRom;
-                rom_bank = 0;
-                ram_bank = 0;
+                bank_low = 1;
+                bank_high = 0;
+
+                rom_fixed = nullptr;
+                rom_window = nullptr;
+                ram_window = nullptr;
+                ram_window_size = (ram_size < RAM_BANK_SIZE) ? ram_size : RAM_BANK_SIZE;
         }
 
         Mbc1::~Mbc1() {
-                delete[] rom;
                 delete[] ram;
         }
 
+        //! The ROM bank at 0x4000-0x7FFF is bank_high:bank_low. In RAM mode
+        //! bank_high also selects the bank at 0x0000-0x3FFF, which only
+        //! matters for ROMs of 1MB or more, and the RAM bank, which only
+        //! matters for 32KB of RAM. Bank numbers wrap at the ROM's size.
+        void Mbc1::remap() {
+                uint32_t rom_mask = (rom_size / BANK_SIZE) - 1;
+                uint32_t window = ((bank_high << 5) | bank_low) & rom_mask;
+                uint32_t fixed = 0;
+                uint32_t ram_offset = 0;
+                if (mem_mode == MemoryModeRam) {
+                        fixed = (bank_high << 5) & rom_mask;
+                        ram_offset = (bank_high * RAM_BANK_SIZE) % ((ram_size > 0) ? ram_size : 1);
+                }
+
+                const uint8_t *fixed_ptr = &rom[fixed * BANK_SIZE];
+                const uint8_t *window_ptr = &rom[window * BANK_SIZE];
+                uint8_t *ram_ptr = (ram_enabled && ram_size > 0) ? &ram[ram_offset] : nullptr;
+                if (fixed_ptr != rom_fixed || window_ptr != rom_window || ram_ptr != ram_window) {
+                        rom_fixed = fixed_ptr;
+                        rom_window = window_ptr;
+                        ram_window = ram_ptr;
+                        remaps++;
+                }
+                rom_bank = static_cast<uint16_t>(window);
+        }
+
         bool Mbc1::write(uint16_t addr, uint8_t value) {
                 // This address range is read-only; so special circuitry exists
                 // such that when we write 0x0A to it, we enable RAM.
                 if (addr >= 0x0000 && addr <= 0x1FFF) {
-                        if ((value & 0x00FF) == 0x000A) {
-                                ram_enabled = true;
-                        } else {
-                                ram_enabled = false;
-                        }
+                        ram_enabled = ((value & 0x0F) == 0x0A);
+                        remap();
                         return true;
                 }
 
@@ -127,15 +183,11 @@ namespace gs {
                 // 20h, 40h, and 60h. Any attempt to address these ROM Banks
                 // will select Bank 21h, 41h, and 61h instead.
                 else if (addr >= 0x2000 && addr <= 0x3FFF) {
-                        // 0x001F is lower 5 bits.
-                        uint8_t bank_num = value & 0x1F;
-                        if (bank_num == 0x0000) {
-                                bank_num = 0x0001;
+                        bank_low = value & 0x1F;
+                        if (bank_low == 0) {
+                                bank_low = 1;
                         }
-
-                        // 0xE0 is upper 3 bits.
-                        rom_bank = rom_bank & 0xE0;
-                        rom_bank = rom_bank | bank_num;
+                        remap();
                         return true;
                 }
 
@@ -144,43 +196,24 @@ namespace gs {
                 // the ROM Bank number, depending on the current ROM/RAM
                 // Mode. (See below.)
                 else if (addr >= 0x4000 && addr <= 0x5FFF) {
-                        switch (mem_mode) {
-                                case MemoryModeRom: {
-                                        // Left shift 5 bits.
-                                        uint8_t bank_num = value << 5;
-                                        // Drop the first 3 bits.
-                                        rom_bank = rom_bank & 0x1F;
-                                        // Add the new 3 front bits.
-                                        rom_bank = rom_bank | bank_num;
-                                        break;
-                                }
-
-                                case MemoryModeRam: {
-                                        ram_bank = value;
-                                        break;
-                                }
-                        }
+                        bank_high = value & 0x03;
+                        remap();
                         return true;
                 }
 
                 // Toggle between RAM and ROM modes.
                 else if (addr >= 0x6000 && addr <= 0x7FFF) {
-                        if ((value & 0x00FF) == 0x0000) {
-                                mem_mode = MemoryModeRom;
-                        } else if ((value &0x00FF) == 0x0001) {
-                                mem_mode = MemoryModeRam;
-                        }
+                        mem_mode = (value & 0x01) ? MemoryModeRam : MemoryModeRom;
+                        remap();
                         return true;
                 }
 
                 // RAM
-                else if (addr >= 0xA000 && addr <= 0xBFFF && ram_enabled) {
-                        assert(ram_bank >= 0 && ram_bank <= 3);
-
-                        uint16_t addr2 = static_cast<uint16_t>(addr - 0xA000);
-                        addr2 = ram_bank * (8 * 1024); // 0, 8, 16 or 24kb offset.
-
-                        ram[addr2] = value;
+                else if (addr >= 0xA000 && addr <= 0xBFFF) {
+                        uint16_t offset = static_cast<uint16_t>(addr - 0xA000);
+                        if (ram_window != nullptr && offset < ram_window_size) {
+                                ram_window[offset] = value;
+                        }
                         return true;
                 }
 
@@ -188,62 +221,48 @@ namespace gs {
         }
 
         bool Mbc1::read(uint16_t addr, uint8_t &value) {
-                // Read from the first ROM bank - always available.
                 if (addr >= 0x0000 && addr <= 0x3FFF) {
-                        value = rom[addr];
+                        value = rom_fixed[addr];
+                        return true;
+                } else if (addr >= 0x4000 && addr <= 0x7FFF) {
+                        value = rom_window[addr - 0x4000];
                         return true;
                 }
 
-                // Read the currently mapped ROM bank.
-                else if (addr >= 0x4000 && addr <= 0x7FFF) {
-                        uint16_t addr2 = static_cast<uint16_t>(addr - 0x4000);
-                        addr2 = rom_bank * (16 * 1024); // Some multiple of 16kb offset.
-                        value = rom[addr2];
+                // RAM; open bus while disabled.
+                else if (addr >= 0xA000 && addr <= 0xBFFF) {
+                        uint16_t offset = static_cast<uint16_t>(addr - 0xA000);
+                        value = (ram_window != nullptr && offset < ram_window_size) ? ram_window[offset] : 0xFF;
                         return true;
                 }
 
-                // RAM
-                else if (addr >= 0xA000 && addr <= 0xBFFF && ram_enabled) {
-                        assert(ram_bank >= 0 && ram_bank <= 3);
+                return false;
+        }
 
-                        uint16_t addr2 = static_cast<uint16_t>(addr - 0xA000);
-                        addr2 = ram_bank * (8 * 1024); // 0, 8, 16 or 24kb offset.
+        uint16_t Mbc1::romBank() const {
+                return rom_bank;
+        }
 
-                        value = ram[addr2];
-                        return true;
+        const uint8_t *Mbc1::readPage(uint16_t addr) {
+                if (addr <= 0x3FFF) {
+                        return &rom_fixed[addr & 0x3F00];
+                } else if (addr <= 0x7FFF) {
+                        return &rom_window[addr & 0x3F00];
                 }
-
-                return false;
+                return writePage(addr);
         }
 
-        void Mbc1::loadRom(uint8_t *data) {
-                for (uint32_t i = 0; i < rom_size; ++i) {
-                        rom[i] = data[i];
-                }
-
-                printf("-- Begin ROM Dump\n");
-                uint32_t width = 16;
-                uint32_t r = 0;
-                printf("     ");
-                for (uint32_t i = 0; i < width; i++) {
-                        printf("%02X ", i);
-                }
-                printf("\n");
-
-                bool running = true;
-                while (running) {
-                        printf("%04X ", r * width);
-                        for (uint32_t c = 0; c < width; c++) {
-                                if ((r * width + c) >= rom_size) {
-                                        running = false;
-                                        break;
-                                }
-                                printf("%02X ", rom[r * width + c]);
-                        }
-                        r++;
-                        printf("\n");
+        uint8_t *Mbc1::writePage(uint16_t addr) {
+                uint32_t offset = static_cast<uint32_t>(addr & 0xFF00) - 0xA000;
+                if (addr >= 0xA000 && addr <= 0xBFFF && ram_window != nullptr && offset < ram_window_size) {
+                        return &ram_window[offset];
                 }
-                printf("-- End ROM Dump\n");
+                return nullptr;
+        }
+
+        void Mbc1::loadRom(const uint8_t *data, uint32_t size) {
+                rom = referenceRom(data, size, rom_size);
+                remap();
         }
 
 } // namespace gs
@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: mbc.hpp
  * Created: 2020-12-28
- * Updated: 2020-12-30
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -27,7 +27,37 @@ namespace gs {
                 virtual ~Mbc() = 0;
                 virtual bool write(uint16_t addr, uint8_t value) = 0;
                 virtual bool read(uint16_t addr, uint8_t &value) = 0;
-                virtual void loadRom(uint8_t *data) = 0;
+
+                //! \brief Use data, size bytes long, as the ROM. It is read
+                //!        in place, so must outlive the Mbc.
+                virtual void loadRom(const uint8_t *data, uint32_t size) = 0;
+
+                //! \return ROM bank currently mapped at 0x4000-0x7FFF
+                virtual uint16_t romBank() const = 0;
+
+                //! \brief Host memory behind the 256-byte page holding addr,
+                //!        for the Bus page table.
+                //! \return first byte of the page, or nullptr if accesses
+                //!         there must go through read()
+                virtual const uint8_t *readPage(uint16_t addr) = 0;
+
+                //! \return as readPage(), for write()
+                virtual uint8_t *writePage(uint16_t addr) = 0;
+
+                //! \return count of bank switches that changed what
+                //!         readPage() or writePage() answer; the Bus
+                //!         refreshes its page table when it moves
+                uint32_t mapVersion() const {
+                        return remaps;
+                }
+
+        protected:
+                //! \return data if it holds all rom_size bytes the header
+                //!         promises, else a copy padded with 0xFF
+                const uint8_t *referenceRom(const uint8_t *data, uint32_t size, uint32_t rom_size);
+
+                uint32_t remaps = 0;
+                uint8_t *rom_copy = nullptr; //!< only made for short ROM files
         };
 
         class MbcNone: public Mbc {
@@ -36,10 +66,13 @@ namespace gs {
                 virtual ~MbcNone();
                 virtual bool write(uint16_t addr, uint8_t value);
                 virtual bool read(uint16_t addr, uint8_t &value);
-                virtual void loadRom(uint8_t *data);
+                virtual void loadRom(const uint8_t *data, uint32_t size);
+                virtual uint16_t romBank() const;
+                virtual const uint8_t *readPage(uint16_t addr);
+                virtual uint8_t *writePage(uint16_t addr);
 
         private:
-                uint8_t rom[32 * 1024];
+                const uint8_t *rom = nullptr;
                 uint32_t rom_size;
                 uint8_t *ram;
                 uint32_t ram_size;
@@ -51,24 +84,36 @@ namespace gs {
                 virtual ~Mbc1();
                 virtual bool write(uint16_t addr, uint8_t value);
                 virtual bool read(uint16_t addr, uint8_t &value);
-                virtual void loadRom(uint8_t *data);
+                virtual void loadRom(const uint8_t *data, uint32_t size);
+                virtual uint16_t romBank() const;
+                virtual const uint8_t *readPage(uint16_t addr);
+                virtual uint8_t *writePage(uint16_t addr);
 
         private:
-                uint8_t *rom;
+                //! Recompute the windows from the bank registers.
+                void remap();
+
+                const uint8_t *rom = nullptr;
                 uint32_t rom_size;
                 uint8_t *ram;
                 uint32_t ram_size;
 
-                bool ram_enabled;
-                uint8_t rom_bank;
-                uint8_t ram_bank;
-
                 enum MemoryModeEnum {
                         MemoryModeRom,
                         MemoryModeRam,
                 };
 
+                bool ram_enabled;
+                uint8_t bank_low; //!< bits 0-4 of the ROM bank; never 0
+                uint8_t bank_high; //!< bits 5-6 of the ROM bank, or the RAM bank
                 MemoryModeEnum mem_mode;
+
+                // Set by remap(); reads and writes only go through these.
+                const uint8_t *rom_fixed; //!< mapped at 0x0000-0x3FFF
+                const uint8_t *rom_window; //!< mapped at 0x4000-0x7FFF
+                uint8_t *ram_window; //!< mapped at 0xA000-0xBFFF; nullptr while disabled
+                uint32_t ram_window_size; //!< bytes of ram_window in use, at most 8KB
+                uint16_t rom_bank; //!< bank behind rom_window
         };
 
 } // namespace gs
@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: operand.hpp
  * Created: 2019-08-31
- * Updated: 2021-01-02
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -9,66 +9,88 @@
  * SPDX-License-Identifier: AGPL-3.0-only
  ******************************************************************************/
 #ifndef OPERAND_VERSION
-#define OPERAND_VERSION "0.1.0" //!< include guard
+#define OPERAND_VERSION "0.2.0" //!< include guard
 
 #include <cstdint>
 
 //! \file operand.hpp
+//!
+//! Operands are small value types constructed on the stack by each opcode
+//! handler and passed by value into the templated operations in cpu.cpp.
+//! There is no common base class: every operation is instantiated for the
+//! concrete operand types it is used with, so get() and set() resolve
+//! statically and are usually inlined.
 
 namespace gs {
 
-        class Bus;
-
-        class Operand {
+        class OperandValueByte {
         public:
-                virtual uint16_t get() = 0;
-                virtual void set(uint16_t) = 0;
+                uint8_t value;
+
+                OperandValueByte(uint8_t in) : value(in) {}
+                uint16_t get() const { return value; }
+                void set(uint16_t) {} // nop for value types.
         };
 
-        class OperandValueByte : public Operand {
+        class OperandValueWord {
         public:
-                uint8_t value;
+                uint16_t value;
 
-                OperandValueByte(uint8_t);
-                virtual uint16_t get();
-                virtual void set(uint16_t value) {}; // nop for value types.
+                OperandValueWord(uint16_t in) : value(in) {}
+                uint16_t get() const { return value; }
+                void set(uint16_t) {} // nop for value types.
         };
 
-        class OperandValueWord : public Operand {
+        //! A byte in memory, accessed through Port's read() and write() so
+        //! the CPU core can time each access; see Cpu::Core.
+        template<typename Port>
+        class OperandAddress {
         public:
-                uint16_t value;
+                Port *port;
+                uint16_t address;
 
-                OperandValueWord(uint16_t);
-                virtual uint16_t get();
-                virtual void set(uint16_t value) {}; // nop for value types.
+                OperandAddress(uint16_t in, Port *p) : port(p), address(in) {}
+                uint16_t get() const { return port->read(address); }
+                void set(uint16_t value) { port->write(address, static_cast<uint8_t>(value)); }
         };
 
-        class OperandAddress : public Operand {
+        //! A little-endian 16-bit value in memory, as written by LD (nn),SP.
+        template<typename Port>
+        class OperandAddressWord {
         public:
-                Bus *bus;
+                Port *port;
                 uint16_t address;
 
-                OperandAddress(uint16_t, Bus *);
-                virtual uint16_t get();
-                virtual void set(uint16_t value);
+                OperandAddressWord(uint16_t in, Port *p) : port(p), address(in) {}
+
+                uint16_t get() const {
+                        uint16_t lo = port->read(address);
+                        uint16_t hi = port->read(address + 1);
+                        return (hi << 8) | lo;
+                }
+
+                void set(uint16_t value) {
+                        port->write(address, static_cast<uint8_t>(value & 0xFF));
+                        port->write(address + 1, static_cast<uint8_t>(value >> 8));
+                }
         };
 
-        class OperandReference : public Operand {
+        class OperandReference {
         public:
                 uint8_t *ref;
 
-                OperandReference(uint8_t &);
-                virtual uint16_t get();
-                virtual void set(uint16_t value);
+                OperandReference(uint8_t &in) : ref(&in) {}
+                uint16_t get() const { return *ref; }
+                void set(uint16_t value) { *ref = static_cast<uint8_t>(value); }
         };
 
-        class OperandPairReference : public Operand {
+        class OperandPairReference {
         public:
                 uint16_t *ref;
 
-                OperandPairReference(uint16_t &);
-                virtual uint16_t get();
-                void set(uint16_t value);
+                OperandPairReference(uint16_t &in) : ref(&in) {}
+                uint16_t get() const { return *ref; }
+                void set(uint16_t value) { *ref = value; }
         };
 
 } // namespace gs
@@ -0,0 +1,133 @@
+/******************************************************************************
+ * File: profile.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file profile.cpp
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "profile.hpp"
+#include "cpu.hpp"
+
+namespace gs {
+
+        std::atomic<bool> Profile::dumpRequested(false);
+
+        static void RequestDump(int) {
+                Profile::dumpRequested.store(true);
+        }
+
+        void Profile::installSignalHandler() {
+#if defined(SIGUSR1)
+                std::signal(SIGUSR1, &RequestDump);
+#endif
+        }
+
+        //! Times an empty sample a few times to find the clock's own cost.
+        Profile::Profile() {
+                clockCost = ~0ULL;
+                for (int i = 0; i < 64; i++) {
+                        uint64_t start = Now();
+                        uint64_t elapsed = Now() - start;
+                        if (elapsed < clockCost) {
+                                clockCost = elapsed;
+                        }
+                }
+                clear();
+        }
+
+        void Profile::clear() {
+                std::memset(counts, 0, sizeof(counts));
+                std::memset(cycles, 0, sizeof(cycles));
+                std::memset(samples, 0, sizeof(samples));
+                std::memset(nanoseconds, 0, sizeof(nanoseconds));
+                seed = 0x9E3779B9;
+                countdown = nextInterval();
+                sampled = NoSample;
+                sampleStart = 0;
+        }
+
+        //! \return a count uniform in [SampleInterval / 2, SampleInterval * 3 / 2)
+        unsigned int Profile::nextInterval() {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                return SampleInterval / 2 + seed % SampleInterval;
+        }
+
+        uint64_t Profile::Now() {
+                auto now = std::chrono::steady_clock::now().time_since_epoch();
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+        }
+
+        void Profile::openSample(unsigned int index) {
+                countdown = nextInterval();
+                sampled = index;
+                sampleStart = Now();
+        }
+
+        //! The sample runs until the next instruction starts, so it includes
+        //! dispatch and, at the end of a block, finding the next one.
+        void Profile::closeSample() {
+                uint64_t elapsed = Now() - sampleStart;
+                nanoseconds[sampled] += (elapsed > clockCost) ? elapsed - clockCost : 0;
+                samples[sampled]++;
+                sampled = NoSample;
+        }
+
+        bool Profile::write(const char *path) const {
+                FILE *file = std::fopen(path, "w");
+                if (file == nullptr) {
+                        return false;
+                }
+
+                std::vector<unsigned int> rows;
+                for (unsigned int i = 0; i < Slots; i++) {
+                        if (counts[i] != 0) {
+                                rows.push_back(i);
+                        }
+                }
+                std::sort(rows.begin(), rows.end(), [this](unsigned int a, unsigned int b) {
+                        return counts[a] > counts[b];
+                });
+
+                std::size_t length = std::strlen(path);
+                bool json = length >= 5 && 0 == std::strcmp(path + length - 5, ".json");
+
+                fputs(json ? "[\n" : "index,mnemonic,count,cycles,samples,sample_ns,estimated_ns\n", file);
+                for (std::size_t r = 0; r < rows.size(); r++) {
+                        unsigned int i = rows[r];
+                        const char *name = Cpu::dispatchName(i);
+                        double estimate = samples[i] ? static_cast<double>(nanoseconds[i]) / samples[i] * counts[i] : 0.0;
+                        const char *format = json
+                                ? "  { \"index\": %u, \"mnemonic\": \"%s\", \"count\": %llu, \"cycles\": %llu, "
+                                  "\"samples\": %llu, \"sample_ns\": %llu, \"estimated_ns\": %.0f }%s\n"
+                                : "0x%03X,\"%s\",%llu,%llu,%llu,%llu,%.0f%s\n";
+                        fprintf(file, format,
+                                i,
+                                name ? name : "?",
+                                static_cast<unsigned long long>(counts[i]),
+                                static_cast<unsigned long long>(cycles[i]),
+                                static_cast<unsigned long long>(samples[i]),
+                                static_cast<unsigned long long>(nanoseconds[i]),
+                                estimate,
+                                (json && r + 1 < rows.size()) ? "," : "");
+                }
+                if (json) {
+                        fputs("]\n", file);
+                }
+
+                return 0 == std::fclose(file);
+        }
+
+} // namespace gs
@@ -0,0 +1,88 @@
+/******************************************************************************
+ * File: profile.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file profile.hpp
+//!
+//! Per-opcode execution histogram.
+//!
+//! The CPU only counts instructions when built with GSGB_PROFILE; otherwise the
+//! hooks compile away and Profile::Enabled is false. Counts are kept per
+//! dispatch index, so superinstructions show up on their own rows. Every
+//! SampleInterval instructions, on average, one instruction is timed on the
+//! host clock; multiply its mean sample by its count to estimate where host
+//! time goes. The interval is jittered so samples don't lock onto one
+//! instruction of a short loop.
+#ifndef PROFILE_VERSION
+#define PROFILE_VERSION "0.1.0" //!< include guard
+
+#include <atomic>
+#include <cstdint>
+
+namespace gs {
+
+        class Profile {
+        public:
+#if defined(GSGB_PROFILE)
+                static const bool Enabled = true;
+#else
+                static const bool Enabled = false;
+#endif
+                static const unsigned int Slots = 0x400; //!< dispatch indices covered
+                static const unsigned int SampleInterval = 4096; //!< mean instructions between timings
+
+                //! Set from a signal handler to ask the host for a dump.
+                static std::atomic<bool> dumpRequested;
+
+                //! Ask for a dump whenever SIGUSR1 arrives.
+                static void installSignalHandler();
+
+                Profile();
+
+                //! Count one instruction about to execute.
+                void record(unsigned int index, unsigned int cycles) {
+                        if (sampled != NoSample) {
+                                closeSample();
+                        }
+                        counts[index]++;
+                        this->cycles[index] += cycles;
+                        if (--countdown == 0) {
+                                openSample(index);
+                        }
+                }
+
+                //! Write the histogram to path: JSON if it ends in ".json",
+                //! CSV otherwise. Rows are sorted by count, most frequent first.
+                //! \return whether the file was written
+                bool write(const char *path) const;
+
+                void clear();
+
+        private:
+                static const unsigned int NoSample = ~0u;
+
+                static uint64_t Now();
+                void openSample(unsigned int index);
+                void closeSample();
+                unsigned int nextInterval();
+
+                uint64_t counts[Slots];
+                uint64_t cycles[Slots]; //!< base cycle cost, not counting taken branches
+                uint64_t samples[Slots];
+                uint64_t nanoseconds[Slots]; //!< total over samples
+                unsigned int countdown;
+                unsigned int sampled; //!< index being timed, or NoSample
+                uint64_t sampleStart;
+                uint64_t clockCost; //!< ns taken by Now() itself, left out of samples
+                uint32_t seed; //!< xorshift state for nextInterval()
+        };
+
+} // namespace gs
+
+#endif // PROFILE_VERSION
@@ -0,0 +1,85 @@
+/******************************************************************************
+ * File: rom_file.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file rom_file.cpp
+#include <cstdio>
+
+#include "rom_file.hpp"
+
+#if defined(__unix__)
+#define GS_ROM_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define GS_ROM_MMAP 0
+#endif
+
+namespace gs {
+
+        RomFile::~RomFile() {
+                close();
+        }
+
+        void RomFile::close() {
+#if GS_ROM_MMAP
+                if (mapping != nullptr) {
+                        munmap(mapping, length);
+                }
+#endif
+                mapping = nullptr;
+                buffer.clear();
+                contents = nullptr;
+                length = 0;
+        }
+
+        bool RomFile::open(const char *path) {
+                close();
+
+#if GS_ROM_MMAP
+                int fd = ::open(path, O_RDONLY);
+                if (fd < 0) {
+                        return false;
+                }
+                struct stat info;
+                if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                        void *p = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (p != MAP_FAILED) {
+                                mapping = p;
+                                contents = static_cast<const uint8_t *>(p);
+                                length = static_cast<std::size_t>(info.st_size);
+                        }
+                }
+                ::close(fd); // The mapping outlives the descriptor.
+                if (mapping != nullptr) {
+                        return true;
+                }
+                // Not mappable, eg. a pipe; read it instead.
+#endif
+                FILE *file = std::fopen(path, "rb");
+                if (file == nullptr) {
+                        return false;
+                }
+                uint8_t chunk[4096];
+                std::size_t n;
+                while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+                        buffer.insert(buffer.end(), chunk, chunk + n);
+                }
+                std::fclose(file);
+                if (buffer.empty()) {
+                        return false;
+                }
+                contents = buffer.data();
+                length = buffer.size();
+                return true;
+        }
+
+} // namespace gs
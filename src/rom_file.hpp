@@ -0,0 +1,62 @@
+/******************************************************************************
+ * File: rom_file.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file rom_file.hpp
+//!
+//! A ROM image opened from disk.
+//!
+//! Where the platform allows, the file is mapped read-only and MAP_PRIVATE
+//! rather than read into memory. Cartridge's MBC reads it in place, so
+//! processes running the same ROM share its pages and nothing is copied at
+//! startup. Elsewhere the contents are read into a buffer.
+#ifndef ROM_FILE_VERSION
+#define ROM_FILE_VERSION "0.1.0" //!< include guard
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gs {
+
+        class RomFile {
+        public:
+                RomFile() = default;
+                ~RomFile();
+                RomFile(const RomFile &) = delete;
+                RomFile &operator=(const RomFile &) = delete;
+
+                //! \brief Map or read the ROM at path.
+                //! \return false if it is missing, unreadable or empty
+                bool open(const char *path);
+
+                //! \return the ROM's contents; valid until close() or
+                //!         destruction, so must outlive any Cartridge
+                //!         built from them
+                const uint8_t *data() const {
+                        return contents;
+                }
+
+                std::size_t size() const {
+                        return length;
+                }
+
+                void close();
+
+        private:
+                void *mapping = nullptr;
+                std::vector<uint8_t> buffer; //!< file contents where it can't be mapped
+
+                const uint8_t *contents = nullptr;
+                std::size_t length = 0;
+        };
+
+} // namespace gs
+
+#endif // ROM_FILE_VERSION
@@ -0,0 +1,124 @@
+/******************************************************************************
+ * File: stack_profile.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file stack_profile.cpp
+#include <cstdio>
+
+#include "stack_profile.hpp"
+
+namespace gs {
+
+        StackProfile::StackProfile() {
+                clear();
+        }
+
+        void StackProfile::clear() {
+                due = 0;
+                depth = 0;
+                counts.clear();
+        }
+
+        bool StackProfile::loadSymbols(const char *path) {
+                FILE *file = std::fopen(path, "r");
+                if (file == nullptr) {
+                        return false;
+                }
+
+                char line[512];
+                while (std::fgets(line, sizeof(line), file) != nullptr) {
+                        unsigned int bank;
+                        unsigned int address;
+                        char label[256];
+                        if (line[0] == ';' || std::sscanf(line, "%x:%x %255s", &bank, &address, label) != 3) {
+                                continue;
+                        }
+                        symbols[Location(static_cast<uint16_t>(address), static_cast<uint16_t>(bank))] = label;
+                }
+
+                std::fclose(file);
+                return true;
+        }
+
+        void StackProfile::sample(uint16_t pc, uint16_t bank, uint64_t now) {
+                uint64_t periods = 1;
+                if (due == 0) {
+                        due = now;
+                } else if (now > due) {
+                        periods += (now - due) / SampleCycles;
+                }
+                due += periods * SampleCycles;
+
+                key.clear();
+                for (unsigned int i = 0; i < depth; i++) {
+                        key.push_back(frames[i].location);
+                }
+                key.push_back(Location(pc, bank));
+                counts[key] += periods;
+        }
+
+        //! \brief Name a location from the symbol table, if it has one.
+        //!
+        //! Call targets (exact) are named by symbol plus offset; sampled PCs
+        //! just take the closest symbol at or before them in the same bank.
+        std::string StackProfile::name(uint32_t location, bool exact) const {
+                char text[32];
+                auto symbol = symbols.upper_bound(location);
+                if (symbol != symbols.begin()) {
+                        --symbol;
+                        if ((symbol->first >> 16) == (location >> 16)) {
+                                uint32_t offset = location - symbol->first;
+                                if (!exact || offset == 0) {
+                                        return symbol->second;
+                                }
+                                std::snprintf(text, sizeof(text), "+0x%X", offset);
+                                return symbol->second + text;
+                        }
+                }
+                std::snprintf(text, sizeof(text), "%02X:%04X", location >> 16, location & 0xFFFF);
+                return text;
+        }
+
+        bool StackProfile::write(const char *path) const {
+                FILE *file = std::fopen(path, "w");
+                if (file == nullptr) {
+                        return false;
+                }
+
+                // Distinct stacks may share names once symbolized.
+                std::map<std::string, uint64_t> folded;
+                for (const auto &entry : counts) {
+                        const std::vector<uint32_t> &stack = entry.first;
+                        std::string line;
+                        std::string frame;
+                        for (std::size_t i = 0; i + 1 < stack.size(); i++) {
+                                frame = name(stack[i], true);
+                                line += frame;
+                                line += ';';
+                        }
+
+                        // Time spent in a routine itself rather than a label inside
+                        // it would otherwise show up as a child of the same name.
+                        std::string leaf = name(stack.back(), false);
+                        if (leaf == frame) {
+                                line.pop_back();
+                        } else {
+                                line += leaf;
+                        }
+                        folded[line] += entry.second;
+                }
+
+                for (const auto &entry : folded) {
+                        std::fprintf(file, "%s %llu\n", entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+                }
+
+                return 0 == std::fclose(file);
+        }
+
+} // namespace gs
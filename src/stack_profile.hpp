@@ -0,0 +1,110 @@
+/******************************************************************************
+ * File: stack_profile.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file stack_profile.hpp
+//!
+//! Guest code sampling profiler.
+//!
+//! Like Profile this is only fed by GSGB_PROFILE builds. CALL and RST push a
+//! frame onto a shadow call stack and RET pops it; every SampleCycles emulated
+//! cycles the stack and current PC are counted. The result is written as
+//! folded stacks, one "outer;inner;leaf count" line per distinct stack, which
+//! flamegraph.pl and most other flame graph tools read directly.
+//!
+//! Locations are ROM bank and address. Load an RGBDS .sym file to name them.
+#ifndef STACK_PROFILE_VERSION
+#define STACK_PROFILE_VERSION "0.1.0" //!< include guard
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gs {
+
+        class StackProfile {
+        public:
+                static const unsigned int MaxDepth = 64; //!< deeper calls are not recorded
+                static const unsigned int SampleCycles = 4096; //!< emulated cycles per sample, about 1kHz
+
+                StackProfile();
+
+                //! Read names from an RGBDS symbol file: "BB:AAAA Name" per line.
+                //! \return whether the file could be read
+                bool loadSymbols(const char *path);
+
+                //! \brief Record a call to target, whose return address is now at sp.
+                void call(uint16_t target, uint16_t bank, uint16_t sp) {
+                        if (depth < MaxDepth) {
+                                frames[depth].location = Location(target, bank);
+                                frames[depth].sp = sp;
+                                depth++;
+                        }
+                }
+
+                //! \brief Record a return popping the address at sp.
+                //!
+                //! Frames are matched on the stack pointer, so frames left behind
+                //! by code that discards its return address are dropped too, and
+                //! RET used as a computed jump pops nothing.
+                void ret(uint16_t sp) {
+                        while (depth > 0 && frames[depth - 1].sp <= sp) {
+                                depth--;
+                        }
+                }
+
+                //! \brief Count the current stack, with pc as the innermost location.
+                //!
+                //! Call for the instruction running at due, which starts at now.
+                //! A sample stands for every SampleCycles period since the last
+                //! one, so time skipped while halted is not lost.
+                void sample(uint16_t pc, uint16_t bank, uint64_t now);
+
+                //! Write folded stacks to path.
+                //! \return whether the file was written
+                bool write(const char *path) const;
+
+                void clear();
+
+                uint64_t due; //!< cycle count at which the next sample is taken
+
+        private:
+                struct Frame {
+                        uint32_t location;
+                        uint16_t sp;
+                };
+
+                static uint32_t Location(uint16_t address, uint16_t bank) {
+                        return (static_cast<uint32_t>(bank) << 16) | address;
+                }
+
+                struct StackHash {
+                        std::size_t operator()(const std::vector<uint32_t> &stack) const {
+                                std::size_t hash = 0;
+                                for (uint32_t location : stack) {
+                                        hash = hash * 31 + location;
+                                }
+                                return hash;
+                        }
+                };
+
+                std::string name(uint32_t location, bool exact) const;
+
+                Frame frames[MaxDepth];
+                unsigned int depth;
+                std::vector<uint32_t> key; //!< scratch for sample()
+                std::unordered_map<std::vector<uint32_t>, uint64_t, StackHash> counts;
+                std::map<uint32_t, std::string> symbols;
+        };
+
+} // namespace gs
+
+#endif // STACK_PROFILE_VERSION
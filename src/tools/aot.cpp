@@ -0,0 +1,340 @@
+/******************************************************************************
+ * File: tools/aot.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file tools/aot.cpp
+//!
+//! gsgb-aot: compile the code reachable in a ROM ahead of time.
+//!
+//!     gsgb-aot ROM OUT.cpp
+//!
+//! Starting from the entry point, the RST targets and the interrupt vectors,
+//! follows every static jump, call and fallthrough, building blocks exactly as
+//! Cpu::runCycles() does. Each block is written out as a C++ function; build
+//! the result as a shared library and pass it to gsgb with --aot:
+//!
+//!     g++ -std=c++17 -O2 -shared -fPIC -Isrc OUT.cpp -o OUT.so
+//!
+//! Code only reached through computed jumps (JP (HL), RET to a pushed address)
+//! or running from RAM is not found, and is interpreted at run time.
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../aot_abi.hpp"
+#include "../block_cache.hpp"
+#include "../bus.hpp"
+#include "../cartridge.hpp"
+#include "../cpu.hpp"
+#include "../rom_file.hpp"
+#include "../video.hpp"
+
+using namespace gs;
+
+//! Opcode register field to aot::Register name; 6 is (HL).
+static const char *const RegisterName[8] = { "B", "C", "D", "E", "H", "L", nullptr, "A" };
+
+//! Low register of BC, DE and HL, by opcode bits 4-5.
+static const char *const PairName[3] = { "C", "E", "L" };
+
+//! A block as written out, keyed by Key(bank, start).
+struct Compiled {
+        uint16_t end;
+        uint32_t cycles;
+        std::string body;
+};
+
+static uint32_t Key(uint16_t bank, uint16_t pc) {
+        return static_cast<uint32_t>(bank) << 16 | pc;
+}
+
+//! \brief Append C++ for op to out.
+//! \return whether op was translated; otherwise the caller interprets it
+static bool Translate(const DecodedOp &op, std::string &out) {
+        char line[128];
+        unsigned int i = op.index;
+        if (i >= 0x100) {
+                return false;
+        }
+
+        auto emit = [&](const char *format, auto... args) {
+                std::snprintf(line, sizeof(line), format, args...);
+                out += "        ";
+                out += line;
+                out += '\n';
+        };
+
+        if (i == 0x00) {
+                return true;
+        }
+        if (i >= 0x40 && i < 0x80 && i != 0x76) {
+                unsigned int dst = (i >> 3) & 7;
+                unsigned int src = i & 7;
+                if (dst == 6) {
+                        emit("h.write(h.bus, Pair(r, L), r[%s]);", RegisterName[src]);
+                } else if (src == 6) {
+                        emit("r[%s] = h.read(h.bus, Pair(r, L));", RegisterName[dst]);
+                } else if (dst != src) {
+                        emit("r[%s] = r[%s];", RegisterName[dst], RegisterName[src]);
+                }
+                return true;
+        }
+        if (i >= 0x80 && i < 0xC0) {
+                unsigned int src = i & 7;
+                if (src == 6) {
+                        emit("Alu(r, %u, h.read(h.bus, Pair(r, L)));", (i >> 3) & 7);
+                } else {
+                        emit("Alu(r, %u, r[%s]);", (i >> 3) & 7, RegisterName[src]);
+                }
+                return true;
+        }
+
+        switch (i & 0xC7) {
+                case 0x04:
+                case 0x05:
+                        if (i == 0x34 || i == 0x35) {
+                                return false;
+                        }
+                        emit("r[%s] = IncDec(r, r[%s], %s);", RegisterName[(i >> 3) & 7],
+                             RegisterName[(i >> 3) & 7], (i & 1) ? "true" : "false");
+                        return true;
+                case 0x06:
+                        if (i == 0x36) {
+                                emit("h.write(h.bus, Pair(r, L), 0x%02X);", op.imm & 0xFF);
+                        } else {
+                                emit("r[%s] = 0x%02X;", RegisterName[(i >> 3) & 7], op.imm & 0xFF);
+                        }
+                        return true;
+                case 0xC6:
+                        emit("Alu(r, %u, 0x%02X);", (i >> 3) & 7, op.imm & 0xFF);
+                        return true;
+        }
+
+        const char *pair = PairName[((i >> 4) & 3) % 3];
+        switch (i) {
+                case 0x01: case 0x11: case 0x21:
+                        emit("SetPair(r, %s, 0x%04X);", pair, op.imm);
+                        return true;
+                case 0x03: case 0x13: case 0x23:
+                        emit("SetPair(r, %s, static_cast<uint16_t>(Pair(r, %s) + 1));", pair, pair);
+                        return true;
+                case 0x0B: case 0x1B: case 0x2B:
+                        emit("SetPair(r, %s, static_cast<uint16_t>(Pair(r, %s) - 1));", pair, pair);
+                        return true;
+                case 0x02: case 0x12:
+                        emit("h.write(h.bus, Pair(r, %s), r[A]);", pair);
+                        return true;
+                case 0x0A: case 0x1A:
+                        emit("r[A] = h.read(h.bus, Pair(r, %s));", pair);
+                        return true;
+                case 0x22: case 0x32:
+                        emit("h.write(h.bus, Pair(r, L), r[A]);");
+                        emit("SetPair(r, L, static_cast<uint16_t>(Pair(r, L) %s 1));", i == 0x22 ? "+" : "-");
+                        return true;
+                case 0x2A: case 0x3A:
+                        emit("r[A] = h.read(h.bus, Pair(r, L));");
+                        emit("SetPair(r, L, static_cast<uint16_t>(Pair(r, L) %s 1));", i == 0x2A ? "+" : "-");
+                        return true;
+                case 0xE0:
+                        emit("h.write(h.bus, 0xFF%02X, r[A]);", op.imm & 0xFF);
+                        return true;
+                case 0xF0:
+                        emit("r[A] = h.read(h.bus, 0xFF%02X);", op.imm & 0xFF);
+                        return true;
+                case 0xE2:
+                        emit("h.write(h.bus, static_cast<uint16_t>(0xFF00 | r[C]), r[A]);");
+                        return true;
+                case 0xF2:
+                        emit("r[A] = h.read(h.bus, static_cast<uint16_t>(0xFF00 | r[C]));");
+                        return true;
+                case 0xEA:
+                        emit("h.write(h.bus, 0x%04X, r[A]);", op.imm);
+                        return true;
+                case 0xFA:
+                        emit("r[A] = h.read(h.bus, 0x%04X);", op.imm);
+                        return true;
+        }
+        return false;
+}
+
+//! \brief Addresses control may continue at after a block ending with op at end.
+static void Successors(const DecodedOp &op, uint16_t end, std::vector<uint16_t> &out) {
+        unsigned int i = op.index;
+        bool falls = true;
+        if (i == 0xC3 || i == 0xC2 || i == 0xCA || i == 0xD2 || i == 0xDA ||
+            i == 0xCD || i == 0xC4 || i == 0xCC || i == 0xD4 || i == 0xDC) {
+                out.push_back(static_cast<uint16_t>(op.imm)); // JP, CALL
+                falls = (i != 0xC3);
+        } else if (i == 0x18 || i == 0x20 || i == 0x28 || i == 0x30 || i == 0x38) {
+                out.push_back(static_cast<uint16_t>(end + static_cast<int8_t>(op.imm))); // JR
+                falls = (i != 0x18);
+        } else if (i < 0x100 && (i & 0xC7) == 0xC7) {
+                out.push_back(static_cast<uint16_t>(i & 0x38)); // RST
+        } else if (i == 0xC9 || i == 0xD9 || i == 0xE9) {
+                falls = false; // RET, RETI, JP (HL)
+        }
+        if (falls) {
+                out.push_back(end);
+        }
+}
+
+int main(int argc, char *argv[]) {
+        if (argc != 3) {
+                fputs("usage: gsgb-aot ROM OUT.cpp\n", stderr);
+                return 1;
+        }
+
+        RomFile rom;
+        if (!rom.open(argv[1])) {
+                fprintf(stderr, "Couldn't open %s.\n", argv[1]);
+                return 1;
+        }
+
+        Cpu cpu;
+        Bus bus;
+        Video video;
+        Cartridge cart(rom.data(), static_cast<unsigned int>(rom.size()));
+        bus.attach(&cpu);
+        bus.attach(&cart);
+        bus.attach(&video);
+        bus.reset();
+
+        uint16_t banks = static_cast<uint16_t>(rom.size() >= 0x8000 ? rom.size() / 0x4000 : 2);
+
+        // Work through bank 0 first: banked targets it calls are queued in
+        // every bank, as which one will be mapped isn't known.
+        std::deque<uint32_t> work;
+        std::set<uint32_t> seen;
+        auto queue = [&](uint16_t bank, uint16_t pc) {
+                if (pc >= 0x8000) {
+                        return;
+                }
+                if (pc < 0x4000) {
+                        bank = 0;
+                }
+                if (seen.insert(Key(bank, pc)).second) {
+                        work.push_back(Key(bank, pc));
+                }
+        };
+        queue(0, 0x0100);
+        for (uint16_t vector = 0x00; vector <= 0x60; vector += 8) {
+                queue(0, vector);
+        }
+
+        std::map<uint32_t, Compiled> functions;
+        unsigned int translated = 0;
+        unsigned int interpreted = 0;
+        while (!work.empty()) {
+                uint32_t key = work.front();
+                work.pop_front();
+                uint16_t bank = static_cast<uint16_t>(key >> 16);
+                uint16_t start = static_cast<uint16_t>(key);
+
+                if (start >= 0x4000) {
+                        bus.write(0x2000, static_cast<uint8_t>(bank & 0x1F));
+                        bus.write(0x4000, static_cast<uint8_t>((bank >> 5) & 0x03));
+                        bus.write(0x6000, 0);
+                        if (cart.romBank() != bank) {
+                                continue; // Not mappable at 0x4000 with this Mbc.
+                        }
+                }
+
+                const Block &block = cpu.decodeBlock(start);
+
+                std::vector<DecodedOp> ops;
+                for (const DecodedOp &op : block.ops) {
+                        DecodedOp parts[4];
+                        unsigned int count = Cpu::unfuse(op, parts);
+                        ops.insert(ops.end(), parts, parts + count);
+                }
+
+                char name[32];
+                std::snprintf(name, sizeof(name), "b_%02X_%04X", bank, start);
+                std::string body = "static void ";
+                body += name;
+                body += "() {\n        uint8_t *r = h.registers;\n        (void)r;\n";
+
+                uint16_t pc = start;
+                bool interpretedLast = false;
+                for (const DecodedOp &op : ops) {
+                        pc = static_cast<uint16_t>(pc + op.length);
+                        interpretedLast = !Translate(op, body);
+                        if (interpretedLast) {
+                                char line[96];
+                                std::snprintf(line, sizeof(line), "        Interpret(h, 0x%04X, 0x%03X, 0x%X); // %s\n",
+                                              pc, op.index, op.imm, Cpu::dispatchName(op.index));
+                                body += line;
+                                interpreted++;
+                        } else {
+                                translated++;
+                        }
+                }
+                if (!interpretedLast) {
+                        char line[48];
+                        std::snprintf(line, sizeof(line), "        *h.pc = 0x%04X;\n", block.end);
+                        body += line;
+                }
+                body += "}\n\n";
+                functions[key] = Compiled{ block.end, block.cycles, body };
+
+                std::vector<uint16_t> next;
+                Successors(ops.back(), block.end, next);
+                for (uint16_t target : next) {
+                        if (target >= 0x4000 && target < 0x8000 && start < 0x4000) {
+                                for (uint16_t b = 1; b < banks; b++) {
+                                        queue(b, target);
+                                }
+                        } else {
+                                queue(bank, target);
+                        }
+                }
+        }
+
+        FILE *out = fopen(argv[2], "w");
+        if (out == nullptr) {
+                fprintf(stderr, "Couldn't open %s.\n", argv[2]);
+                return 1;
+        }
+
+        fprintf(out, "// Generated by gsgb-aot from %s; do not edit.\n", argv[1]);
+        fputs("#include \"aot_abi.hpp\"\n\nusing namespace gs;\nusing namespace gs::aot;\n\nstatic AotHooks h;\n\n", out);
+        for (const auto &function : functions) {
+                fputs(function.second.body.c_str(), out);
+        }
+
+        fputs("static const AotBlock blocks[] = {\n", out);
+        for (const auto &function : functions) {
+                uint16_t bank = static_cast<uint16_t>(function.first >> 16);
+                uint16_t start = static_cast<uint16_t>(function.first);
+                fprintf(out, "        { 0x%02X, 0x%04X, 0x%04X, %u, &b_%02X_%04X },\n",
+                        bank, start, function.second.end, function.second.cycles, bank, start);
+        }
+        fputs("};\n\n", out);
+
+        fputs("static void bind(const AotHooks &hooks) {\n        h = hooks;\n}\n\n", out);
+        fputs("static const AotModule module = {\n        { ", out);
+        for (unsigned int i = 0; i < sizeof(AotMagic); i++) {
+                fprintf(out, "'%c'%s", AotMagic[i], i + 1 < sizeof(AotMagic) ? ", " : "");
+        }
+        fprintf(out, " },\n        AotVersion,\n        0x%04X,\n        0x%016llXULL,\n        %zu,\n        blocks,\n        &bind\n};\n\n",
+                cart.globalChecksum(), static_cast<unsigned long long>(cart.contentHash()), functions.size());
+        fputs("extern \"C\" const gs::AotModule *gsgb_aot_module() {\n        return &module;\n}\n", out);
+
+        if (0 != fclose(out)) {
+                fprintf(stderr, "Couldn't write %s.\n", argv[2]);
+                return 1;
+        }
+
+        fprintf(stderr, "%zu blocks, %u ops translated, %u interpreted.\n", functions.size(), translated, interpreted);
+        return 0;
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * File: tools/trace_dump.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file tools/trace_dump.cpp
+//!
+//! gsgb-trace: print a binary trace written by a GSGB_TRACE build as text.
+//!
+//!     gsgb-trace FILE [FIRST [COUNT]]
+//!
+//! Prints COUNT records, or all of them, starting at record FIRST.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../cpu.hpp"
+#include "../trace.hpp"
+
+using namespace gs;
+
+int main(int argc, char *argv[]) {
+        if (argc < 2) {
+                fputs("usage: gsgb-trace FILE [FIRST [COUNT]]\n", stderr);
+                return 1;
+        }
+
+        FILE *file = fopen(argv[1], "rb");
+        if (file == nullptr) {
+                fprintf(stderr, "Couldn't open %s.\n", argv[1]);
+                return 1;
+        }
+
+        TraceHeader header;
+        if (fread(&header, sizeof(header), 1, file) != 1 ||
+            memcmp(header.magic, Trace::Magic, sizeof(header.magic)) != 0 ||
+            header.recordSize != sizeof(TraceRecord)) {
+                fprintf(stderr, "%s is not a gsgb trace.\n", argv[1]);
+                fclose(file);
+                return 1;
+        }
+
+        unsigned long long first = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 0;
+        unsigned long long count = (argc > 3) ? strtoull(argv[3], nullptr, 0) : ~0ULL;
+        if (first > 0 && fseeko(file, static_cast<off_t>(first * sizeof(TraceRecord)), SEEK_CUR) != 0) {
+                fprintf(stderr, "Couldn't seek to record %llu.\n", first);
+                fclose(file);
+                return 1;
+        }
+
+        static TraceRecord records[4096];
+        unsigned long long printed = 0;
+        while (printed < count) {
+                size_t n = fread(records, sizeof(TraceRecord), sizeof(records) / sizeof(records[0]), file);
+                if (n == 0) {
+                        break;
+                }
+
+                for (size_t i = 0; i < n && printed < count; i++, printed++) {
+                        const TraceRecord &r = records[i];
+                        printf("%12llu  %04X  %04X  %-12s  AF:%04X BC:%04X DE:%04X HL:%04X SP:%04X\n",
+                               static_cast<unsigned long long>(r.cycle),
+                               r.pc,
+                               r.opcode,
+                               Cpu::instructionName(r.opcode),
+                               r.af, r.bc, r.de, r.hl, r.sp);
+                }
+        }
+
+        fclose(file);
+        return 0;
+}
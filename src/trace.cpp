@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File: trace.cpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file trace.cpp
+#include <chrono>
+#include <cstring>
+
+#include "trace.hpp"
+
+namespace gs {
+
+        constexpr char Trace::Magic[8];
+
+        Trace::Trace(const char *path) : head(0), tail(0), stopping(false) {
+                ring = new TraceRecord[Capacity];
+                file = std::fopen(path, "wb");
+                if (file == nullptr) {
+                        return;
+                }
+
+                TraceHeader header = {};
+                std::memcpy(header.magic, Magic, sizeof(header.magic));
+                header.recordSize = sizeof(TraceRecord);
+                std::fwrite(&header, sizeof(header), 1, file);
+
+                writer = std::thread(&Trace::drain, this);
+        }
+
+        Trace::~Trace() {
+                if (file != nullptr) {
+                        stopping.store(true, std::memory_order_release);
+                        writer.join();
+                        std::fclose(file);
+                }
+                delete[] ring;
+        }
+
+        //! \brief Write records to file until stopped and the ring is empty.
+        //!
+        //! Each pass writes everything available, in at most two pieces when
+        //! the readable span wraps around the end of the ring.
+        void Trace::drain() {
+                for (;;) {
+                        bool stop = stopping.load(std::memory_order_acquire);
+                        uint64_t t = tail.load(std::memory_order_relaxed);
+                        uint64_t h = head.load(std::memory_order_acquire);
+
+                        if (h == t) {
+                                if (stop) {
+                                        break;
+                                }
+                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                continue;
+                        }
+
+                        uint64_t first = t & (Capacity - 1);
+                        uint64_t count = h - t;
+                        if (first + count > Capacity) {
+                                count = Capacity - first;
+                        }
+                        std::fwrite(ring + first, sizeof(TraceRecord), count, file);
+                        tail.store(t + count, std::memory_order_release);
+                }
+                std::fflush(file);
+        }
+
+} // namespace gs
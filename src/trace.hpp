@@ -0,0 +1,100 @@
+/******************************************************************************
+ * File: trace.hpp
+ * Created: 2026-10-17
+ * Updated: 2026-10-17
+ * Package: gsgb
+ * Creator: Aaron Oman (GrooveStomp)
+ * Homepage: https://git.sr.ht/~groovestomp/gsgb/
+ * Copyright 2019 - 2021, Aaron Oman and the gsgb contributors
+ * SPDX-License-Identifier: AGPL-3.0-only
+ ******************************************************************************/
+//! \file trace.hpp
+//!
+//! Binary instruction trace.
+//!
+//! The CPU only records instructions when built with GSGB_TRACE; otherwise the
+//! recording calls compile away and Trace::Enabled is false. Each instruction
+//! is written as a fixed-size TraceRecord into a single-producer,
+//! single-consumer ring buffer, and a background thread drains the ring to a
+//! file in large writes. Should the writer fall behind, the emulator waits for
+//! space rather than dropping records, so traces are always complete.
+//!
+//! Use gsgb-trace (src/tools/trace_dump.cpp) to turn a trace file into text.
+#ifndef TRACE_VERSION
+#define TRACE_VERSION "0.1.0" //!< include guard
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+namespace gs {
+
+        //! State before one instruction executes. Multi-byte fields are
+        //! stored in host byte order.
+        struct TraceRecord {
+                uint64_t cycle; //!< Cpu::cycles when the instruction started
+                uint16_t pc;
+                uint16_t opcode; //!< 0xCBnn for prefixed opcodes
+                uint16_t af;
+                uint16_t bc;
+                uint16_t de;
+                uint16_t hl;
+                uint16_t sp;
+                uint16_t reserved;
+        };
+        static_assert(sizeof(TraceRecord) == 24, "trace files rely on the record size");
+
+        //! Written once at the start of every trace file.
+        struct TraceHeader {
+                char magic[8]; //!< Trace::Magic
+                uint32_t recordSize; //!< sizeof(TraceRecord)
+                uint32_t reserved;
+        };
+
+        class Trace {
+        public:
+#if defined(GSGB_TRACE)
+                static const bool Enabled = true;
+#else
+                static const bool Enabled = false;
+#endif
+                static constexpr char Magic[8] = { 'G', 'S', 'G', 'B', 'T', 'R', 'C', '1' };
+                static const uint32_t Capacity = 1 << 20; //!< records; must be a power of two
+
+                //! Open path for writing and start the drain thread.
+                //! \see good()
+                Trace(const char *path);
+
+                //! Drain all remaining records and close the file.
+                ~Trace();
+
+                //! \return whether the file was opened
+                bool good() const {
+                        return file != nullptr;
+                }
+
+                //! Append a record. Only call this from one thread.
+                void record(const TraceRecord &r) {
+                        uint64_t h = head.load(std::memory_order_relaxed);
+                        while (h - tail.load(std::memory_order_acquire) >= Capacity) {
+                                std::this_thread::yield();
+                        }
+                        ring[h & (Capacity - 1)] = r;
+                        head.store(h + 1, std::memory_order_release);
+                }
+
+        private:
+                void drain();
+
+                TraceRecord *ring;
+                std::atomic<uint64_t> head; //!< next record to be written by the emulator
+                std::atomic<uint64_t> tail; //!< next record to be written to file
+                std::atomic<bool> stopping;
+                std::FILE *file;
+                std::thread writer;
+        };
+
+} // namespace gs
+
+#endif // TRACE_VERSION
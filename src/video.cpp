@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: video.cpp
  * Created: 2021-01-04
- * Updated: 2021-01-04
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -10,10 +10,21 @@
  ******************************************************************************/
 //! \file video.cpp
 
+#include "bus.hpp"
 #include "video.hpp"
 
 namespace gs {
 
+        template<uint8_t Video::*Register>
+        static uint8_t ReadRegister(void *video, uint16_t) {
+                return static_cast<Video *>(video)->*Register;
+        }
+
+        template<uint8_t Video::*Register>
+        static void WriteRegister(void *video, uint16_t, uint8_t value) {
+                static_cast<Video *>(video)->*Register = value;
+        }
+
         bool Video::write(uint16_t addr, uint8_t value) {
                 if (addr >= 0x8000 && addr <= 0x9FFF) {
                         uint16_t addr2 = addr - 0x8000;
@@ -26,28 +37,6 @@ namespace gs {
                         return true;
                 }
 
-                switch (addr) {
-                        case 0xFF40:
-                                lcdc = value;
-                                return true;
-
-                        case 0xFF42:
-                                scrolly = value;
-                                return true;
-
-                        case 0xFF43:
-                                scrollx = value;
-                                return true;
-
-                        case 0xFF4A:
-                                wndposy = value;
-                                return true;
-
-                        case 0xFF4B:
-                                wndposx = value;
-                                return true;
-                }
-
                 return false;
         }
 
@@ -63,29 +52,181 @@ namespace gs {
                         return true;
                 }
 
-                switch (addr) {
-                        case 0xFF40:
-                                value = lcdc;
-                                return true;
+                return false;
+        }
+
+        void Video::connect(Bus &bus) {
+                IoPort port;
+                port.device = this;
+
+                // LCDC, STAT and LYC decide when the next interrupt is raised.
+                port.reschedules = true;
+
+                port.read = &ReadRegister<&Video::lcdc>;
+                port.write = [](void *video, uint16_t, uint8_t value) {
+                        Video *self = static_cast<Video *>(video);
+                        if (!(self->lcdc & 0x80) && (value & 0x80)) {
+                                self->origin = self->now();
+                                self->caughtUp = self->origin;
+                        }
+                        self->lcdc = value;
+                };
+                bus.connect(0xFF40, port);
+
+                port.read = [](void *video, uint16_t) -> uint8_t {
+                        const Video *self = static_cast<const Video *>(video);
+                        return self->stat | ((self->ly() == self->lyc) ? 0x04 : 0) | self->mode();
+                };
+                port.write = [](void *video, uint16_t, uint8_t value) {
+                        static_cast<Video *>(video)->stat = value & 0x78;
+                };
+                bus.connect(0xFF41, port);
+
+                port.read = &ReadRegister<&Video::lyc>;
+                port.write = &WriteRegister<&Video::lyc>;
+                bus.connect(0xFF45, port);
+
+                port.reschedules = false;
+
+                port.read = [](void *video, uint16_t) -> uint8_t {
+                        return static_cast<Video *>(video)->ly();
+                };
+                port.write = [](void *, uint16_t, uint8_t) {}; // LY is read-only.
+                bus.connect(0xFF44, port);
+
+                port.read = &ReadRegister<&Video::scrolly>;
+                port.write = &WriteRegister<&Video::scrolly>;
+                bus.connect(0xFF42, port);
+
+                port.read = &ReadRegister<&Video::scrollx>;
+                port.write = &WriteRegister<&Video::scrollx>;
+                bus.connect(0xFF43, port);
+
+                port.read = &ReadRegister<&Video::wndposy>;
+                port.write = &WriteRegister<&Video::wndposy>;
+                bus.connect(0xFF4A, port);
+
+                port.read = &ReadRegister<&Video::wndposx>;
+                port.write = &WriteRegister<&Video::wndposx>;
+                bus.connect(0xFF4B, port);
+        }
 
-                        case 0xFF42:
-                                value = scrolly;
-                                return true;
+        void Video::reset() {
+                lcdc = 0;
+                stat = 0;
+                lyc = 0;
+                origin = now();
+                caughtUp = origin;
+        }
 
-                        case 0xFF43:
-                                value = scrollx;
-                                return true;
+        uint8_t Video::ly() const {
+                if (!(lcdc & 0x80)) {
+                        return 0;
+                }
+                return static_cast<uint8_t>(((now() - origin) % CyclesPerFrame) / CyclesPerLine);
+        }
 
-                        case 0xFF4A:
-                                value = wndposy;
-                                return true;
+        //! \return 0: HBlank, 1: VBlank, 2: OAM search, 3: pixel transfer
+        uint8_t Video::mode() const {
+                if (!(lcdc & 0x80)) {
+                        return 0;
+                }
 
-                        case 0xFF4B:
-                                value = wndposx;
-                                return true;
+                uint64_t phase = (now() - origin) % CyclesPerFrame;
+                uint64_t dot = phase % CyclesPerLine;
+                if (phase / CyclesPerLine >= VisibleLines) {
+                        return 1;
                 }
+                return (dot < 80) ? 2 : (dot < 252) ? 3 : 0;
+        }
 
-                return false;
+        //! \return clock of the next line start or mode change after t
+        uint64_t Video::nextTransition(uint64_t t) const {
+                uint64_t phase = (t - origin) % CyclesPerFrame;
+                uint64_t dot = phase % CyclesPerLine;
+                uint64_t lineStart = t - dot;
+
+                if (phase / CyclesPerLine < VisibleLines) {
+                        if (dot < 80) {
+                                return lineStart + 80;
+                        } else if (dot < 252) {
+                                return lineStart + 252;
+                        }
+                }
+                return lineStart + CyclesPerLine;
+        }
+
+        //! \return IF bits raised by the transition at t
+        uint8_t Video::raise(uint64_t t) const {
+                uint64_t phase = (t - origin) % CyclesPerFrame;
+                uint64_t line = phase / CyclesPerLine;
+                uint64_t dot = phase % CyclesPerLine;
+                uint8_t raised = 0;
+
+                if (dot == 0) {
+                        if (line == lyc && (stat & 0x40)) {
+                                raised |= IrqStat;
+                        }
+                        if (line < VisibleLines && (stat & 0x20)) {
+                                raised |= IrqStat;
+                        }
+                        if (line == VisibleLines) {
+                                raised |= IrqVBlank;
+                                raised |= (stat & 0x10) ? IrqStat : 0;
+                        }
+                } else if (dot == 252 && (stat & 0x08)) {
+                        raised |= IrqStat;
+                }
+
+                return raised;
+        }
+
+        uint64_t Video::nextEvent(uint64_t now) const {
+                if (!(lcdc & 0x80)) {
+                        return UINT64_MAX;
+                }
+
+                // Only the start of VBlank matters unless HBlank, OAM or LYC
+                // interrupts are selected.
+                if (!(stat & 0x68)) {
+                        uint64_t phase = (now - origin) % CyclesPerFrame;
+                        uint64_t vblank = VisibleLines * CyclesPerLine;
+                        uint64_t delta = (vblank + CyclesPerFrame - phase) % CyclesPerFrame;
+                        return now + (delta ? delta : CyclesPerFrame);
+                }
+                return nextTransition(now);
+        }
+
+        uint64_t Video::nextChange(uint16_t addr, uint64_t now) const {
+                if (!(lcdc & 0x80)) {
+                        return UINT64_MAX;
+                }
+
+                if (addr == 0xFF44) {
+                        uint64_t dot = (now - origin) % CyclesPerLine;
+                        return now - dot + CyclesPerLine;
+                }
+                return nextTransition(now);
+        }
+
+        uint8_t Video::advance(uint64_t now) {
+                if (!(lcdc & 0x80) || now <= caughtUp) {
+                        caughtUp = (now > caughtUp) ? now : caughtUp;
+                        return 0;
+                }
+
+                // Everything recurs within a frame, so older events add nothing.
+                if (now - caughtUp > CyclesPerFrame) {
+                        caughtUp = now - CyclesPerFrame;
+                }
+
+                uint8_t raised = 0;
+                for (uint64_t t = nextTransition(caughtUp); t <= now; t = nextTransition(t)) {
+                        raised |= raise(t);
+                }
+                caughtUp = now;
+
+                return raised;
         }
 
 } // namespace gs
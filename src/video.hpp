@@ -1,7 +1,7 @@
 /******************************************************************************
  * File: video.hpp
  * Created: 2021-01-04
- * Updated: 2021-01-04
+ * Updated: 2026-10-17
  * Package: gsgb
  * Creator: Aaron Oman (GrooveStomp)
  * Homepage: https://git.sr.ht/~groovestomp/gsgb/
@@ -15,6 +15,7 @@
 #include <cstdint>
 
 namespace gs {
+        class Bus;
 
         /*
           Background Tile Map:
@@ -52,8 +53,20 @@ Bit 	Name 	Usage notes
          */
 
         // $8000 - $A000 is VRAM
+        //!
+        //! LY and the STAT mode aren't stored; they are derived from the CPU's
+        //! cycle counter on demand, so the video needs no per-instruction
+        //! stepping. Interrupts are raised in bulk by advance(), which the Bus
+        //! calls whenever someone needs them to be current.
         class Video {
         public:
+                static const unsigned int CyclesPerLine = 456;
+                static const unsigned int LinesPerFrame = 154;
+                static const unsigned int CyclesPerFrame = CyclesPerLine * LinesPerFrame;
+                static const unsigned int VisibleLines = 144;
+                static const uint8_t IrqVBlank = 0x01; //!< IF bit
+                static const uint8_t IrqStat = 0x02; //!< IF bit
+
                 // $8000 - $8FFF sprite data table
                 // $8800 - $97FF bg data table
                 // $9800 - $98FF tile map 1
@@ -66,10 +79,54 @@ Bit 	Name 	Usage notes
                 uint8_t scrolly;
                 uint8_t wndposx;
                 uint8_t wndposy;
+                uint8_t stat = 0; //!< interrupt selects only, bits 3-6
+                uint8_t lyc = 0;
+
+                const uint64_t *clock = nullptr; //!< Cpu::cycles; set by the Bus
 
+                //! VRAM and OAM; registers are reached through connect().
                 bool write(uint16_t addr, uint8_t value);
                 bool read(uint16_t addr, uint8_t &value);
+                void reset();
+
+                //! Register handlers for LCDC, STAT, SCY, SCX, LY, LYC, WY
+                //! and WX with bus.
+                void connect(Bus &bus);
+
+                //! \brief Host memory behind the 256-byte page holding addr,
+                //!        for the Bus page table.
+                //!
+                //! VRAM is never locked out, as mode 3 access isn't
+                //! emulated, so its pages don't change. OAM's page runs into
+                //! the unusable range and stays on read() and write().
+                //! \return first byte of the page, or nullptr
+                uint8_t *page(uint16_t addr) {
+                        return (addr >= 0x8000 && addr <= 0x9FFF) ? &vram[(addr & 0xFF00) - 0x8000] : nullptr;
+                }
+
+                uint8_t ly() const;
+                uint8_t mode() const;
+
+                //! \return clock of the next event after now that may raise an
+                //!         interrupt, or UINT64_MAX if there is none
+                uint64_t nextEvent(uint64_t now) const;
+
+                //! \return clock after now when STAT (0xFF41) or LY (0xFF44) may
+                //!         next change, or UINT64_MAX
+                uint64_t nextChange(uint16_t addr, uint64_t now) const;
+
+                //! Raise every interrupt due up to and including now.
+                //! \return IF bits raised
+                uint8_t advance(uint64_t now);
         private:
+                uint64_t now() const {
+                        return (clock != nullptr) ? *clock : 0;
+                }
+                uint64_t nextTransition(uint64_t t) const;
+                uint8_t raise(uint64_t t) const;
+
+                uint64_t origin = 0; //!< clock when the LCD was last switched on
+                uint64_t caughtUp = 0; //!< clock up to which interrupts have been raised
                 // TODO: X window stuff here.
         };
 